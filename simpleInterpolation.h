@@ -18,12 +18,32 @@
  * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#ifndef SIMPLE_INTERPOLATION_H
+#define SIMPLE_INTERPOLATION_H
+
 #include <vector>
 #include <tuple>
 #include <cfenv>
 #include <memory>
 #include <cmath>
-#include <tuple>
+#include <algorithm>
+#include <type_traits>
+#include <span>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <bit>
+#include <limits>
+#include <array>
+#include <optional>
+#if defined(__GNUC__) && __has_include(<experimental/simd>)
+#include <experimental/simd>
+#endif
+#if defined(__cpp_lib_experimental_parallel_simd)
+#define SIMPLE_INTERPOLATION_PORTABLE_SIMD 1
+#else
+#define SIMPLE_INTERPOLATION_PORTABLE_SIMD 0
+#endif
 
 namespace simpleTools {
     enum class InterpolationResultType {
@@ -36,171 +56,2104 @@ namespace simpleTools {
         divideByZero
     };
 
+    //How getY() and nearestY() locate the pair of points bracketing x.
+    enum class SearchMethod {
+        linearScan,     //walk the table from the top on every query, O(n)
+        binarySearch,   //bisect the sorted table, O(log n)
+        eytzinger,      //bisect a breadth-first copy of the X values, O(log n) with fewer cache misses
+        bPlusTree,      //descend a static B+ tree of two cache line nodes, O(log n / log B), B = 128 / sizeof(X)
+        learned,        //predict the position from a piecewise linear fit of X, then search a few pairs around it
+        interpolationSearch,    //guess the position from x's value, O(log log n) when X is close to even;
+                                //bisects whatever range is left after a few guesses, so never worse than O(log n)
+        bucketDirectory         //split the X range into 2^k equal buckets, then bisect the one bucket x falls in
+    };
+
+    //Order of the x values handed to the batch forms of getY() and nearestY().
+    enum class QueryOrder {
+        detect,     //check the batch; ascending batches are walked alongside the table
+        ascending,  //x never decreases: one pass over table and batch together, at most O(n + m)
+        unordered   //search the table for each x on its own
+    };
+
+    //The curve splineInterpolation fits through a table.
+    enum class SplineType {
+        natural,    //cubic spline with no curvature at either end
+        clamped,    //cubic spline with a given slope at each end
+        monotone    //piecewise cubic Hermite (PCHIP) with Fritsch-Carlson slopes: rises only where the table
+                    //rises and falls only where it falls, never overshooting a pair
+    };
+
+    //Batch kernels for getY() and nearestY(). Scalar code finds each point's segment and lays a block
+    //of points out column by column; a kernel then evaluates the block 2-16 lanes at a time. Kernels
+    //repeat the scalar arithmetic operation for operation, and neither fuses a multiply and an add,
+    //so results match getY() and nearestY() bit for bit.
+    namespace simd {
+        enum class instructionSet {
+            baseline,   //16 byte vectors: SSE2 on x86-64, whatever the target offers elsewhere
+            avx2,       //32 byte vectors
+            avx512,     //64 byte vectors
+            portable    //std::experimental::simd at the target's native width: NEON on ARM
+        };
+
+#if defined(__GNUC__)
+        template<class X, class Y>
+        constexpr bool handles = std::is_same_v<X, Y> && (std::is_same_v<X, float> || std::is_same_v<X, double>);
+#else
+        template<class X, class Y>
+        constexpr bool handles = false;
+#endif
+
+        //what a kernel works out for each lane
+        enum class answer {
+            interpolated,   //getY(): y and divideByZero
+            nearest         //nearestY(): y only, leftY or rightY, whichever X is fewer precisions from x
+        };
+
+        //product, unchanged, but no longer something the compiler may fuse with the add it feeds.
+        //GCC contracts across statements wherever -mfma or -march allow it; Clang only within one
+        //expression, unless given -ffp-contract=fast. A barrier per product keeps fp-contract=off
+        //off the functions themselves, which would stop them being inlined. Vectors go by reference:
+        //always inlined, this takes on the instruction set of the kernel it's used in.
+        template<class T>
+#if defined(__GNUC__)
+        [[gnu::always_inline]]
+#endif
+        constexpr void keepApart(T &product) {
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+            product = __builtin_assoc_barrier(product);
+#elif defined(__GNUC__) && !defined(__clang__)
+            if (std::is_constant_evaluated()) return;
+            volatile T kept = product;      //older GCCs can't see through the round trip to memory
+            product = kept;
+#else
+            (void) product;
+#endif
+        }
+
+        //keepApart() for a scalar product inside an expression
+        template<class T>
+        constexpr T unfused(T product) {
+            keepApart(product);
+            return product;
+        }
+
+        //all ones or all zeros, as wide as T
+        template<class T>
+        using laneMask = std::conditional_t<sizeof(T) == 8, std::int64_t, std::int32_t>;
+
+        template<class T>
+        struct block {
+            static constexpr std::size_t size = 64;     //a multiple of the widest vector
+            alignas(64) T x[size];
+            alignas(64) T leftX[size];
+            alignas(64) T leftY[size];
+            alignas(64) T rightX[size];
+            alignas(64) T rightY[size];
+            alignas(64) laneMask<T> exact[size];        //answer is leftY
+            alignas(64) laneMask<T> extrapolate[size];  //off either end: y = mx + b
+            alignas(64) T y[size];                      //out
+            alignas(64) laneMask<T> divideByZero[size]; //out
+            T precision;                                //nearest: the table's
+        };
+
+#if defined(__GNUC__)
+        //One statement per operation, in the order the scalar code does them.
+        template<class T, std::size_t Bytes>
+        [[gnu::always_inline]] inline void evaluateLanes(std::size_t count, block<T> &b) {
+            typedef T vec __attribute__((vector_size(Bytes)));
+            typedef laneMask<T> mask __attribute__((vector_size(Bytes)));
+            constexpr std::size_t lanes = Bytes / sizeof(T);
+
+            for (std::size_t i = 0; i < count; i += lanes) {
+                vec x, leftX, leftY, rightX, rightY;
+                mask exact, extrapolate;
+                std::memcpy(&x, b.x + i, Bytes);
+                std::memcpy(&leftX, b.leftX + i, Bytes);
+                std::memcpy(&leftY, b.leftY + i, Bytes);
+                std::memcpy(&rightX, b.rightX + i, Bytes);
+                std::memcpy(&rightY, b.rightY + i, Bytes);
+                std::memcpy(&exact, b.exact + i, Bytes);
+                std::memcpy(&extrapolate, b.extrapolate + i, Bytes);
+
+                vec denominator = rightX - leftX;
+                vec magnitude = denominator < 0 ? -denominator : denominator;
+                mask tooSmall = magnitude < static_cast<T>(0.0001);
+                vec rise = rightY - leftY;
+                vec slope = rise / denominator;
+
+                vec offset = x - leftX;                 //leftY + (x - leftX) * slope
+                vec step = offset * slope;
+                keepApart(step);
+                vec inside = leftY + step;
+
+                vec atLeft = slope * leftX;             //m * x + (leftY - m * leftX)
+                keepApart(atLeft);
+                vec intercept = leftY - atLeft;
+                vec product = slope * x;
+                keepApart(product);
+                vec outside = product + intercept;
+
+                vec y = extrapolate ? outside : inside;
+                y = tooSmall ? vec{} : y;
+                y = exact ? leftY : y;
+                mask divideByZero = tooSmall & ~exact;
+                std::memcpy(b.y + i, &y, Bytes);
+                std::memcpy(b.divideByZero + i, &divideByZero, Bytes);
+            }
+        }
+
+        //closerOf(): the differences' magnitudes over the precision, truncated to int. closerOf()
+        //divides in double and rounds back to T, which for float gives the float quotient (double
+        //has more than twice float's bits), so the lanes stay in T. Exact lanes take leftY.
+        template<class T, std::size_t Bytes>
+        [[gnu::always_inline]] inline void nearestLanes(std::size_t count, block<T> &b) {
+            typedef T vec __attribute__((vector_size(Bytes)));
+            typedef laneMask<T> mask __attribute__((vector_size(Bytes)));
+            constexpr std::size_t lanes = Bytes / sizeof(T);
+            typedef int intVec __attribute__((vector_size(lanes * sizeof(int))));
+
+            for (std::size_t i = 0; i < count; i += lanes) {
+                vec x, leftX, leftY, rightX, rightY;
+                mask exact;
+                std::memcpy(&x, b.x + i, Bytes);
+                std::memcpy(&leftX, b.leftX + i, Bytes);
+                std::memcpy(&leftY, b.leftY + i, Bytes);
+                std::memcpy(&rightX, b.rightX + i, Bytes);
+                std::memcpy(&rightY, b.rightY + i, Bytes);
+                std::memcpy(&exact, b.exact + i, Bytes);
+
+                vec left = x - leftX;
+                vec right = x - rightX;
+                left = left < 0 ? -left : left;
+                right = right < 0 ? -right : right;
+                left = left / b.precision;
+                right = right / b.precision;
+                //int(), then back: a T truncated to int always converts back exactly, and comparing
+                //in T keeps the mask T's width
+                vec leftDelta = __builtin_convertvector(__builtin_convertvector(left, intVec), vec);
+                vec rightDelta = __builtin_convertvector(__builtin_convertvector(right, intVec), vec);
+
+                mask takeLeft = (leftDelta < rightDelta) | exact;
+                vec y = takeLeft ? leftY : rightY;
+                std::memcpy(b.y + i, &y, Bytes);
+            }
+        }
+
+        template<class T, std::size_t Bytes>
+        [[gnu::always_inline]] inline void lanesFor(answer a, std::size_t count, block<T> &b) {
+            if (a == answer::nearest) nearestLanes<T, Bytes>(count, b);
+            else evaluateLanes<T, Bytes>(count, b);
+        }
+
+        template<class T>
+        void baselineKernel(answer a, std::size_t count, block<T> &b) {
+            lanesFor<T, 16>(a, count, b);
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+        template<class T>
+        [[gnu::target("avx2")]] void avx2Kernel(answer a, std::size_t count, block<T> &b) {
+            lanesFor<T, 32>(a, count, b);
+        }
+
+        template<class T>
+        [[gnu::target("avx512f")]] void avx512Kernel(answer a, std::size_t count, block<T> &b) {
+            lanesFor<T, 64>(a, count, b);
+        }
+#endif
+
+#if SIMPLE_INTERPOLATION_PORTABLE_SIMD
+//GCC 12's static_simd_cast() between double and int trips -Wmaybe-uninitialized inside its own
+//AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+        //evaluateLanes() and nearestLanes() written against std::experimental::simd, so the ARM build
+        //gets NEON with no intrinsics and any other target can run the same code. Flags travel as T,
+        //-1 or 0.
+        template<class T>
+        void portableNearest(std::size_t count, block<T> &b) {
+            namespace stdx = std::experimental;
+            using vec = stdx::native_simd<T>;
+            using flags = stdx::rebind_simd_t<laneMask<T>, vec>;
+            using ints = stdx::rebind_simd_t<int, vec>;
+            constexpr std::size_t lanes = vec::size();
+
+            for (std::size_t i = 0; i < count; i += lanes) {
+                vec x(b.x + i, stdx::element_aligned);
+                vec leftX(b.leftX + i, stdx::element_aligned);
+                vec leftY(b.leftY + i, stdx::element_aligned);
+                vec rightX(b.rightX + i, stdx::element_aligned);
+                vec rightY(b.rightY + i, stdx::element_aligned);
+                auto exact = stdx::static_simd_cast<vec>(flags(b.exact + i, stdx::element_aligned)) != 0;
+
+                vec left = stdx::abs(vec(x - leftX)) / b.precision;
+                vec right = stdx::abs(vec(x - rightX)) / b.precision;
+                vec leftDelta = stdx::static_simd_cast<vec>(stdx::static_simd_cast<ints>(left));
+                vec rightDelta = stdx::static_simd_cast<vec>(stdx::static_simd_cast<ints>(right));
+
+                vec y = rightY;
+                stdx::where(leftDelta < rightDelta || exact, y) = leftY;
+                y.copy_to(b.y + i, stdx::element_aligned);
+            }
+        }
+
+#pragma GCC diagnostic pop
+
+        //simd objects aren't arithmetic types keepApart() can take, so on GCC the whole kernel is built
+        //with fp-contract off. It's only ever called through evaluate(), so that costs no inlining.
+        template<class T>
+#if !defined(__clang__)
+        [[gnu::optimize("fp-contract=off")]]
+#endif
+        void portableKernel(answer a, std::size_t count, block<T> &b) {
+            if (a == answer::nearest) return portableNearest(count, b);
+            namespace stdx = std::experimental;
+            using vec = stdx::native_simd<T>;
+            using flags = stdx::rebind_simd_t<laneMask<T>, vec>;
+            constexpr std::size_t lanes = vec::size();
+
+            for (std::size_t i = 0; i < count; i += lanes) {
+                vec x(b.x + i, stdx::element_aligned);
+                vec leftX(b.leftX + i, stdx::element_aligned);
+                vec leftY(b.leftY + i, stdx::element_aligned);
+                vec rightX(b.rightX + i, stdx::element_aligned);
+                vec rightY(b.rightY + i, stdx::element_aligned);
+                auto exact = stdx::static_simd_cast<vec>(flags(b.exact + i, stdx::element_aligned)) != 0;
+                auto extrapolate = stdx::static_simd_cast<vec>(flags(b.extrapolate + i, stdx::element_aligned)) != 0;
+
+                vec denominator = rightX - leftX;
+                auto tooSmall = stdx::abs(denominator) < static_cast<T>(0.0001);
+                vec rise = rightY - leftY;
+                vec slope = rise / denominator;
+
+                vec offset = x - leftX;                 //leftY + (x - leftX) * slope
+                vec step = offset * slope;
+                vec inside = leftY + step;
+
+                vec atLeft = slope * leftX;             //m * x + (leftY - m * leftX)
+                vec intercept = leftY - atLeft;
+                vec product = slope * x;
+                vec outside = product + intercept;
+
+                vec y = inside;
+                stdx::where(extrapolate, y) = outside;
+                stdx::where(tooSmall, y) = vec(0);
+                stdx::where(exact, y) = leftY;
+                vec divideByZero(0);
+                stdx::where(tooSmall && !exact, divideByZero) = vec(-1);
+                y.copy_to(b.y + i, stdx::element_aligned);
+                stdx::static_simd_cast<flags>(divideByZero).copy_to(b.divideByZero + i, stdx::element_aligned);
+            }
+        }
+#endif
+#endif
+
+        inline bool supported(instructionSet isa) {
+            if (isa == instructionSet::portable) return SIMPLE_INTERPOLATION_PORTABLE_SIMD;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_cpu_init();
+            switch (isa) {
+                case instructionSet::avx512:
+                    return __builtin_cpu_supports("avx512f");
+                case instructionSet::avx2:
+                    return __builtin_cpu_supports("avx2");
+                default:
+                    return true;
+            }
+#else
+            return isa == instructionSet::baseline;
+#endif
+        }
+
+        //the widest instruction set this CPU runs, checked once. ARM builds take the portable kernel.
+        inline instructionSet best() {
+#if SIMPLE_INTERPOLATION_PORTABLE_SIMD && (defined(__ARM_NEON) || defined(__aarch64__))
+            return instructionSet::portable;
+#endif
+            static instructionSet const chosen = supported(instructionSet::avx512) ? instructionSet::avx512 :
+                                                 supported(instructionSet::avx2) ? instructionSet::avx2 :
+                                                 instructionSet::baseline;
+            return chosen;
+        }
+
+        //Evaluate the first count points of a block. isa must be supported().
+        template<class T>
+        void evaluate(instructionSet isa, std::size_t count, block<T> &b, answer a = answer::interpolated) {
+#if defined(__GNUC__)
+#if defined(__x86_64__) || defined(__i386__)
+            if (isa == instructionSet::avx512) return avx512Kernel<T>(a, count, b);
+            if (isa == instructionSet::avx2) return avx2Kernel<T>(a, count, b);
+#endif
+#if SIMPLE_INTERPOLATION_PORTABLE_SIMD
+            if (isa == instructionSet::portable) return portableKernel<T>(a, count, b);
+#endif
+            (void) isa;
+            baselineKernel<T>(a, count, b);
+#else
+            (void) isa;
+            (void) count;
+            (void) b;
+            (void) a;
+#endif
+        }
+    }
+
+    //std::allocator, except every block starts on a cache line
+    template<class T>
+    struct cacheLineAllocator {
+        using value_type = T;
+        static constexpr std::size_t alignment = 64;
+
+        cacheLineAllocator() = default;
+
+        template<class U>
+        cacheLineAllocator(cacheLineAllocator<U> const &) {}
+
+        T *allocate(std::size_t n) {
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+        }
+
+        void deallocate(T *p, std::size_t) { ::operator delete(p, std::align_val_t(alignment)); }
+
+        template<class U>
+        bool operator==(cacheLineAllocator<U> const &) const { return true; }
+    };
+
+    template<class T>
+    using cacheLineVector = std::vector<T, cacheLineAllocator<T> >;
+
+    //A 64 bit hash of a block of memory, run as four independent lanes of 8 bytes so it keeps up
+    //with memory bandwidth. For spotting a table that changed, not for security.
+    inline std::uint64_t checksum(void const *data, std::size_t bytes, std::uint64_t seed = 0) {
+        constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ull;
+        constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+        unsigned char const *p = static_cast<unsigned char const *>(data);
+        std::uint64_t lane[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+        std::size_t i = 0;
+        for (; i + 32 <= bytes; i += 32) {
+            for (int j = 0; j < 4; ++j) {
+                std::uint64_t word;
+                std::memcpy(&word, p + i + 8 * j, sizeof(word));
+                lane[j] = std::rotl(lane[j] + word * prime2, 31) * prime1;
+            }
+        }
+        std::uint64_t hash = std::rotl(lane[0], 1) + std::rotl(lane[1], 7) + std::rotl(lane[2], 12) + std::rotl(lane[3], 18);
+        hash += bytes;
+        for (; i < bytes; ++i) hash = std::rotl(hash ^ (p[i] * prime1), 11) * prime2;
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        return hash;
+    }
+
+    //One coordinate of a table: a read-only view of either the caller's memory or a copy held here.
+    //Copies of a column that holds its own data view the copy's data.
+    template<class T>
+    class tableColumn {
+    public:
+        tableColumn() = default;
+        tableColumn(tableColumn const &other) : owned(other.owned), values(other.ownsData() ? owned : other.values) {}
+        tableColumn(tableColumn &&) = default;  //moving a vector keeps its buffer, so the view stays good
+
+        tableColumn &operator=(tableColumn const &other) {
+            if (this != &other) {
+                owned = other.owned;
+                values = other.ownsData() ? std::span<const T>(owned) : other.values;
+            }
+            return *this;
+        }
+        tableColumn &operator=(tableColumn &&) = default;
+
+        void own(cacheLineVector<T> &&data) {
+            owned = std::move(data);
+            values = owned;
+        }
+
+        void borrow(std::span<const T> data) {
+            owned = cacheLineVector<T>();
+            values = data;
+        }
+
+        void clear() { borrow({}); }
+
+        T const &operator[](std::size_t i) const { return values[i]; }
+        std::size_t size() const { return values.size(); }
+        bool empty() const { return values.empty(); }
+        std::size_t heapBytes() const { return owned.capacity() * sizeof(T); }   //0 when borrowed
+        T const &front() const { return values.front(); }
+        T const &back() const { return values.back(); }
+        T const *data() const { return values.data(); }
+        auto begin() const { return values.begin(); }
+        auto end() const { return values.end(); }
+        operator std::span<const T>() const { return values; }
+
+    private:
+        cacheLineVector<T> owned;
+        std::span<const T> values;
+
+        bool ownsData() const { return !owned.empty() && values.data() == owned.data(); }
+    };
+
+    //What validate() concluded about a table. A table that was checked once, say before being
+    //written to a file, can be handed these facts instead of being scanned again.
+    struct tableFacts {
+        InterpolationResultType status;
+        bool duplicates;
+        std::optional<bool> uniform;    //as judged with the precision the table was checked with;
+                                        //empty to have the constructor find out
+    };
+
     template<class X, class Y>
     class interpolation {
     public:
-        explicit interpolation(std::shared_ptr<std::vector<std::pair<X, Y> > > const a, X p) :
+        //The table is sealed on construction: it is checked once and the verdict is cached.
+        explicit interpolation(std::shared_ptr<std::vector<std::pair<X, Y> > > const a, X p,
+                               SearchMethod s = SearchMethod::binarySearch) :
             intrpData(a),
-            precision(p) {}
+            precision(p),
+            search(s) {
+            validate();
+        }
+
+        //A view of X and Y arrays the caller owns; nothing is copied. The arrays must outlive the
+        //object, and a change to them needs a validate() before the next query. Arrays of different
+        //lengths are dataIncomplete.
+        explicit interpolation(std::span<const X> xs, std::span<const Y> ys, X p,
+                               SearchMethod s = SearchMethod::binarySearch) :
+            xSource(xs),
+            ySource(ys),
+            precision(p),
+            search(s) {
+            validate();
+        }
+
+        //A view, as above, of arrays validate() has already passed; facts stands in for the O(n)
+        //checks. The search index is taken from index, bytes saved by indexSnapshot(), when that
+        //was made for the same SearchMethod and the table's checksum still matches, and its
+        //learnedError or bucketBits setting replaces the default. The index is used in place, so
+        //index too must outlive the object. Otherwise, or when index is empty, the search index
+        //is built as usual.
+        explicit interpolation(std::span<const X> xs, std::span<const Y> ys, X p, SearchMethod s,
+                               tableFacts const &facts, std::span<const unsigned char> index = {}) :
+            xSource(xs),
+            ySource(ys),
+            precision(p),
+            search(s) {
+            xColumn.borrow(xs);
+            yColumn.borrow(ys);
+            duplicates = facts.duplicates;
+            tableStatus = facts.status;
+            if (xs.size() != ys.size() || xs.size() < 2) tableStatus = InterpolationResultType::dataIncomplete;
+            if (!facts.uniform) checkGrid(false);
+            else if (*facts.uniform) checkGrid(true);
+            else uniform = false;
+            if (!adoptIndex(index)) buildIndexes();
+        }
+
+        //Check the table has at least 2 pairs in ascending X order and note any repeated X.
+        //Queries work from a copy of a shared table taken here, so call validate() again after
+        //changing the table.
+        InterpolationResultType validate() {
+            tableStatus = checkTable();
+            checkGrid(false);
+            buildIndexes();
+            return tableStatus;
+        }
+
+        //the verdict of the last validate(), for the tableFacts constructor
+        tableFacts facts() const { return {tableStatus, duplicates, uniform}; }
+
+        X getPrecision() const { return precision; }
+
+        SearchMethod searchMethod() const { return search; }
+
+        //true when two or more pairs share an X value; valid as of the last validate()
+        bool hasDuplicates() const { return duplicates; }
+
+        //true when every X is within precision of an evenly spaced grid. Lookups on such a table
+        //compute the index directly, O(1), whatever the SearchMethod other than linearScan.
+        bool isUniform() const { return uniform; }
+
+        //Optional compiled form for getY(). Slope, intercept and the divide by zero check are worked
+        //out once per segment, including the extrapolation segments either side of the table, so a
+        //query is a search plus one multiply-add, fused where the target has a fast FMA. Results may
+        //differ from the uncompiled form in the last bits. validate() recompiles.
+        InterpolationResultType compile() {
+            compiled = true;
+            buildSegments();
+            return tableStatus;
+        }
+
+        //SearchMethod::learned: the most pairs a prediction may be off by. Smaller bounds mean more line
+        //segments in the fit and shorter searches after it. Rebuilds the index.
+        InterpolationResultType setLearnedError(std::size_t maxError) {
+            learnedError = maxError;
+            buildLearnedIndex();
+            return tableStatus;
+        }
+
+        //line segments in the SearchMethod::learned fit; 0 for other methods
+        std::size_t learnedSegments() const { return learnedFirst.size(); }
+
+        //SearchMethod::bucketDirectory: use 2^bits buckets. 0, the default, picks about one bucket per
+        //pair. A directory is never more than about four buckets per pair, so past log2(pairs) + 2 bits
+        //the limit is used instead and false returned. Rebuilds the directory; status() says whether
+        //the table can have one.
+        bool setBucketBits(unsigned bits) {
+            bucketBits = bits;
+            buildBuckets();
+            return xColumn.empty() || bits <= maxBucketBits();
+        }
+
+        //buckets in the SearchMethod::bucketDirectory directory; 0 for other methods
+        std::size_t bucketCount() const { return bucketStart.empty() ? 0 : bucketStart.size() - 1; }
+
+        //heap memory held by the search index of the chosen SearchMethod, beyond the table itself;
+        //an index taken from a snapshot is not counted
+        std::size_t indexBytes() const {
+            return eytzingerKeys.heapBytes() + eytzingerRank.heapBytes() +
+                   bTreeKeys.heapBytes() + (bTreeNodes.capacity() + bTreeOffset.capacity()) * sizeof(std::size_t) +
+                   learnedFirst.heapBytes() + learnedRuns.heapBytes() + bucketStart.heapBytes();
+        }
+
+        //checksum() of the X and Y columns as of the last validate(). Tables of long double may
+        //give different checksums for equal values, through the unused bytes of each X.
+        std::uint64_t dataChecksum() const {
+            std::span<const X> xs = xColumn;
+            std::span<const Y> ys = yColumn;
+            return checksum(ys.data(), ys.size_bytes(), checksum(xs.data(), xs.size_bytes()));
+        }
+
+        //The search index of the chosen SearchMethod, with the setting and table checksum it was
+        //built from, as bytes to store and hand to the tableFacts constructor in a later run.
+        //The bytes are only read back by builds with the same sizeof(std::size_t) and float formats.
+        cacheLineVector<unsigned char> indexSnapshot() const {
+            indexSnapshotHeader header{};
+            header.version = indexSnapshotVersion;
+            header.method = static_cast<std::uint8_t>(search);
+            header.xBytes = static_cast<std::uint8_t>(sizeof(X));
+            header.sizeBytes = static_cast<std::uint8_t>(sizeof(std::size_t));
+            header.runBytes = static_cast<std::uint8_t>(sizeof(learnedRun));
+            header.wideDigits = static_cast<std::uint8_t>(std::numeric_limits<wideX>::digits);
+            header.count = xColumn.size();
+            header.dataChecksum = dataChecksum();
+            header.setting = indexSetting();
+
+            cacheLineVector<unsigned char> snapshot(sizeof(header));
+            putArray<X>(snapshot, eytzingerKeys);
+            putArray<std::size_t>(snapshot, eytzingerRank);
+            putArray<X>(snapshot, bTreeKeys);
+            putArray<std::size_t>(snapshot, bTreeNodes);
+            putArray<std::size_t>(snapshot, bTreeOffset);
+            putArray<X>(snapshot, learnedFirst);
+            putArray<learnedRun>(snapshot, learnedRuns);
+            putArray<std::size_t>(snapshot, bucketStart);
+            header.indexChecksum = checksum(snapshot.data() + sizeof(header), snapshot.size() - sizeof(header));
+            std::memcpy(snapshot.data(), &header, sizeof(header));
+            return snapshot;
+        }
+
+        //true when the search index came from a snapshot rather than being built
+        bool indexAdopted() const { return adopted; }
+
+        //true when the chosen SearchMethod has a search index, built or adopted; false for methods
+        //that don't use one and for grids
+        bool hasIndex() const {
+            switch (search) {
+                case SearchMethod::eytzinger: return !eytzingerKeys.empty();
+                case SearchMethod::bPlusTree: return !bTreeNodes.empty();
+                case SearchMethod::learned: return !learnedRuns.empty();
+                case SearchMethod::bucketDirectory: return !bucketStart.empty();
+                default: return false;
+            }
+        }
+
+        //For engines that evaluate the table their own way and reuse its checks and search.
+        //verdict of the last validate()
+        InterpolationResultType status() const { return tableStatus; }
+
+        //the table as of the last validate()
+        std::span<const X> xValues() const { return xColumn; }
+        std::span<const Y> yValues() const { return yColumn; }
+
+        //index of the first pair whose X is greater than x, size() if none, found with the table's
+        //SearchMethod. Only meaningful when status() is OK.
+        std::size_t bracket(X x) const { return upperBound(x); }
+
+        //bracket(x), searching outwards from hint, an earlier answer; quicker when x is close to the
+        //x that gave it, as in an ascending batch
+        std::size_t bracket(X x, std::size_t hint) const { return gallop(x, hint); }
+
+        //Queries are const and keep their working state on the stack, so one instance can be shared
+        //by any number of threads. Don't call validate() or compile() while queries are in flight.
 
         //The simplest interpolation is to return the closest Y to a given X.
-        std::tuple<InterpolationResultType, Y> nearestY(X x) {
-            InterpolationResultType preflightResult = preflightFailed();
-            if (preflightResult != InterpolationResultType::OK) return {preflightResult, 0};
+        std::tuple<InterpolationResultType, Y> nearestY(X x) const {
+            if (tableStatus != InterpolationResultType::OK) return {tableStatus, 0};
+            return nearestOf(x, locate(x));
+        }
+
+        //given interpolation point, x, compute it's corresponding y value
+        std::tuple<InterpolationResultType, Y> getY(X x) const {
+            if (tableStatus != InterpolationResultType::OK) return {tableStatus, 0};
+            return interpolationOf(x, locate(x));
+        }
 
-            //if leftX > x, then leftX is the closest
-            if (leftX > x) {
-                return {InterpolationResultType::lessThanData, leftY};
+        //Batch forms: one result per x is written to ys, and to results when it is given. The table
+        //is checked once per batch and nothing is allocated. Returns the table's status, or
+        //dataIncomplete without writing anything when ys or results are shorter than xs.
+        //float and double tables pick the nearest Y with the widest SIMD kernel the CPU runs
+        InterpolationResultType nearestY(std::span<const X> xs, std::span<Y> ys,
+                                         std::span<InterpolationResultType> results = {},
+                                         QueryOrder order = QueryOrder::detect) const {
+            if constexpr (simd::handles<X, Y>) {
+                return simdBatch<simd::answer::nearest>(xs, ys, results, order, simd::best());
             }
+            return batch(xs, ys, results, order, [&](std::size_t i, X x, segment where) {
+                store(ys, results, i, nearestOf(x, where));
+            });
+        }
 
-            std::tuple<InterpolationResultType, Y> scanResult = scanVector(x);
-            if (std::get<0>(scanResult) == InterpolationResultType::exactMatch) {
-                return {InterpolationResultType::OK, std::get<1>(scanResult)};
+        //float and double tables that aren't compiled are evaluated with the widest SIMD kernel the CPU runs
+        InterpolationResultType getY(std::span<const X> xs, std::span<Y> ys,
+                                     std::span<InterpolationResultType> results = {},
+                                     QueryOrder order = QueryOrder::detect) const {
+            if constexpr (simd::handles<X, Y>) {
+                if (!compiled) return simdBatch<simd::answer::interpolated>(xs, ys, results, order, simd::best());
             }
+            return batch(xs, ys, results, order, [&](std::size_t i, X x, segment where) {
+                store(ys, results, i, interpolationOf(x, where));
+            });
+        }
+
+    private:
+        template<class Q> friend class fixedPointInterpolation;
+
+        //As the shared table constructor, but never treated as a grid, whose index is computed in
+        //floating point. For fixedPointInterpolation.
+        explicit interpolation(std::shared_ptr<std::vector<std::pair<X, Y> > > const a, X p, SearchMethod s,
+                               bool gridAllowed) :
+            intrpData(a),
+            precision(p),
+            search(s),
+            grids(gridAllowed) {
+            validate();
+        }
 
-            if (std::get<0>(scanResult) == InterpolationResultType::dataUnsorted) {
-                return {InterpolationResultType::dataUnsorted, 0};
+        std::shared_ptr<std::vector<std::pair<X, Y> > > intrpData;
+        std::span<const X> xSource;     //the caller's arrays, when there's no intrpData
+        std::span<const Y> ySource;
+        //The table as of the last validate(), one column per coordinate, so searches only pull X
+        //into cache and Y is read just for the pairs either side of x.
+        tableColumn<X> xColumn;
+        tableColumn<Y> yColumn;
+        X precision; //how close is close enough?
+        SearchMethod search;
+        InterpolationResultType tableStatus; //verdict of the last validate()
+        bool duplicates;
+
+        //Where x lies in the table.
+        struct segment {
+            //lessThanData or greaterThanData when off either end, exactMatch, or OK when between two pairs
+            InterpolationResultType result;
+            //exactMatch: the pair hit. Otherwise the first pair whose X is greater than x, size() if none.
+            std::size_t index;
+        };
+
+        //y = slope * x + intercept for one segment of the compiled table
+        struct segmentCoefficients {
+            Y slope;
+            Y intercept;
+            InterpolationResultType status;
+        };
+        bool compiled = false;
+        //segments[i] spans pairs i-1 and i; segments[0] and segments[n] extrapolate off either end
+        std::vector<segmentCoefficients> segments;
+
+        InterpolationResultType checkTable() {
+            duplicates = false;
+            if (intrpData) {
+                cacheLineVector<X> xs;
+                cacheLineVector<Y> ys;
+                xs.reserve(intrpData->size());
+                ys.reserve(intrpData->size());
+                for (std::pair<X, Y> const &item : *intrpData) {
+                    xs.push_back(item.first);
+                    ys.push_back(item.second);
+                }
+                xColumn.own(std::move(xs));
+                yColumn.own(std::move(ys));
+            } else {
+                xColumn.borrow(xSource);
+                yColumn.borrow(ySource);
+                if (xSource.size() != ySource.size()) {
+                    xColumn.borrow({});
+                    yColumn.borrow({});
+                    return InterpolationResultType::dataIncomplete;
+                }
             }
+            if (xColumn.size() < 2) return InterpolationResultType::dataIncomplete;
 
-            //if rightX <  x, then the interpolation point is to the right of the table.
-            if (x > rightX) {
-                return {InterpolationResultType::greaterThanData, intrpData->rbegin()->second};
+            for (std::size_t i = 1; i < xColumn.size(); ++i) {
+                if (xColumn[i] < xColumn[i - 1]) return InterpolationResultType::dataUnsorted;
+                if (xColumn[i] == xColumn[i - 1]) duplicates = true;
             }
+            return InterpolationResultType::OK;
+        }
 
-            //find the closest X to x and return that Y
-            X leftDelta = (fabs(x - leftX) / precision);
-            X rightDelta = (fabs(x - rightX) / precision);
-            if (int(leftDelta) < int(rightDelta)) {
-                return {InterpolationResultType::OK, leftY};
+        std::pair<X, Y> point(std::size_t i) const { return {xColumn[i], yColumn[i]}; }
+
+        void buildIndexes() {
+            adopted = false;
+            buildEytzinger();
+            buildBPlusTree();
+            buildLearnedIndex();
+            buildBuckets();
+            if (compiled) buildSegments();
+        }
+
+        void buildSegments() {
+            segments.clear();
+            if (tableStatus != InterpolationResultType::OK) return;
+
+            std::size_t n = xColumn.size();
+            segments.reserve(n + 1);
+            segments.push_back(fitSegment(point(0), point(1)));
+            for (std::size_t i = 1; i < n; ++i) segments.push_back(fitSegment(point(i - 1), point(i)));
+            segments.push_back(fitSegment(point(n - 2), point(n - 1)));
+        }
+
+        static segmentCoefficients fitSegment(std::pair<X, Y> const &lhs, std::pair<X, Y> const &rhs) {
+            std::tuple<InterpolationResultType, Y> result = computeSlope(lhs.first, lhs.second, rhs.first, rhs.second);
+            if (std::get<0>(result) == InterpolationResultType::divideByZero) {
+                return {0, 0, InterpolationResultType::divideByZero};
             }
-            return {InterpolationResultType::OK, rightY};
+            Y m = std::get<1>(result);
+            return {m, static_cast<Y>(lhs.second - m * lhs.first), InterpolationResultType::OK};
         }
 
-        //given interpolation point, x, compute it's corresponding y value
-        std::tuple<InterpolationResultType, Y> getY(X x) {
-            InterpolationResultType preflightResult = preflightFailed();
-            if (preflightResult != InterpolationResultType::OK) return {preflightResult, 0};
+        //The compiled form never meets the batch kernels, so it's free to fuse.
+        static Y multiplyAdd(Y m, Y x, Y b) {
+#ifdef FP_FAST_FMA
+            if constexpr (std::is_floating_point_v<Y>) return std::fma(m, x, b);
+#endif
+            return m * x + b;
+        }
+
+        //SearchMethod::eytzinger: node k's children are 2k and 2k+1, so the first few levels of the
+        //tree share a handful of cache lines and a descent can prefetch the line holding all of a
+        //node's descendants log2(64 / sizeof(X)) levels down: four levels for 4 byte keys, three for
+        //doubles. Slot 0 is unused. eytzingerRank maps a node back to its index in the table.
+        tableColumn<X> eytzingerKeys;
+        tableColumn<std::size_t> eytzingerRank;
 
-            //if leftX > x, then the interpolation point is to the left of the table.
-            //compute y = mx + b, using the 1st two pairs to determine that equation
-            if (leftX > x) {
-                ++head;
-                rightX = head->first;
-                rightY = head->second;
-                return interpolateOnSegment(x);
+        void buildEytzinger() {
+            eytzingerKeys.clear();
+            eytzingerRank.clear();
+            if (search != SearchMethod::eytzinger || tableStatus != InterpolationResultType::OK || uniform) return;
+
+            cacheLineVector<X> keys(xColumn.size() + 1);
+            cacheLineVector<std::size_t> rank(xColumn.size() + 1);
+            std::size_t next = 0;
+            fillEytzinger(keys, rank, 1, next);
+            eytzingerKeys.own(std::move(keys));
+            eytzingerRank.own(std::move(rank));
+        }
+
+        //in-order walk of the tree, handing out the sorted Xs as it goes
+        void fillEytzinger(cacheLineVector<X> &keys, cacheLineVector<std::size_t> &rank, std::size_t k, std::size_t &next) const {
+            if (k > xColumn.size()) return;
+            fillEytzinger(keys, rank, 2 * k, next);
+            keys[k] = xColumn[next];
+            rank[k] = next++;
+            fillEytzinger(keys, rank, 2 * k + 1, next);
+        }
+
+        //upperBound() on the Eytzinger tree. The descent has no data dependent branches: each step goes
+        //right when x is not below the node. Going right is a 1 bit, so stripping the trailing 1s and
+        //the 0 above them lands on the last node we went left at, the first X greater than x.
+        std::size_t eytzingerUpperBound(X x) const {
+            constexpr std::size_t prefetchStride = std::max<std::size_t>(1, 64 / sizeof(X));  //a cache line of descendants
+            std::size_t n = xColumn.size();
+            X const *keys = eytzingerKeys.data();
+            std::size_t k = 1;
+            while (k <= n) {
+#ifdef __GNUC__
+                __builtin_prefetch(keys + k * prefetchStride);   //a hint, so running off the end does no harm
+#endif
+                k = 2 * k + static_cast<std::size_t>(!(x < keys[k]));
             }
+            k >>= std::countr_one(k) + 1;
+            return k == 0 ? n : eytzingerRank[k];
+        }
 
-            std::tuple<InterpolationResultType, Y> scanResult = scanVector(x);
-            if (std::get<0>(scanResult) == InterpolationResultType::exactMatch) {
-                return {InterpolationResultType::OK, std::get<1>(scanResult)};
+        //SearchMethod::bPlusTree. Each node is a 128 byte run of keys, two cache lines most CPUs fetch
+        //together; key j of an inner node is the first X under its child j + 1. The leaves are the X
+        //column itself. Inner layers are stored root first in bTreeKeys; bTreeNodes[h] counts the
+        //nodes in layer h, the leaves being layer 0.
+        static constexpr std::size_t bTreeFanout = std::max<std::size_t>(2, 128 / sizeof(X));   //keys per node
+        tableColumn<X> bTreeKeys;
+        std::vector<std::size_t> bTreeNodes;
+        std::vector<std::size_t> bTreeOffset;   //first key of each inner layer
+
+        //fills the slots of children that don't exist; sorts after every X
+        static constexpr X bTreePadding() {
+            if constexpr (std::numeric_limits<X>::has_infinity) return std::numeric_limits<X>::infinity();
+            else return std::numeric_limits<X>::max();
+        }
+
+        //the node count of each layer of a tree over n pairs and where each inner layer starts in
+        //bTreeKeys; returns the number of inner keys
+        static std::size_t bTreeShape(std::size_t n, std::vector<std::size_t> &nodes, std::vector<std::size_t> &offsets) {
+            nodes.assign(1, (n + bTreeFanout - 1) / bTreeFanout);
+            while (nodes.back() > 1) nodes.push_back((nodes.back() + bTreeFanout) / (bTreeFanout + 1));
+
+            offsets.assign(nodes.size(), 0);
+            std::size_t total = 0;
+            for (std::size_t h = nodes.size(); h-- > 1;) {
+                offsets[h] = total;
+                total += nodes[h] * bTreeFanout;
+            }
+            return total;
+        }
+
+        void buildBPlusTree() {
+            bTreeKeys.clear();
+            bTreeNodes.clear();
+            bTreeOffset.clear();
+            if (search != SearchMethod::bPlusTree || tableStatus != InterpolationResultType::OK || uniform) return;
+
+            std::size_t n = xColumn.size();
+            cacheLineVector<X> keys(bTreeShape(n, bTreeNodes, bTreeOffset), bTreePadding());
+
+            std::size_t leavesPerChild = 1;   //leaves under one node of the layer below
+            for (std::size_t h = 1; h < bTreeNodes.size(); ++h) {
+                for (std::size_t k = 0; k < bTreeNodes[h]; ++k) {
+                    for (std::size_t j = 0; j < bTreeFanout; ++j) {
+                        std::size_t first = (k * (bTreeFanout + 1) + j + 1) * leavesPerChild * bTreeFanout;
+                        if (first < n) keys[bTreeOffset[h] + k * bTreeFanout + j] = xColumn[first];
+                    }
+                }
+                leavesPerChild *= bTreeFanout + 1;
             }
+            bTreeKeys.own(std::move(keys));
+        }
 
-            if (std::get<0>(scanResult) == InterpolationResultType::dataUnsorted) {
-                return {InterpolationResultType::dataUnsorted, 0};
+        //how many of a node's keys are not above x. Floating point and 32/64 bit integer keys are
+        //compared 16 bytes at a time, and the -1 each key above x leaves in its lane is summed down
+        //the node before a single sum across the lanes.
+        static std::size_t countNotAbove(X const *node, X x) {
+#if defined(__GNUC__)
+            if constexpr (std::is_arithmetic_v<X> && !std::is_same_v<X, long double> &&
+                          (sizeof(X) == 4 || sizeof(X) == 8)) {
+                typedef X vec __attribute__((vector_size(16)));
+                typedef simd::laneMask<X> mask __attribute__((vector_size(16)));
+                constexpr std::size_t lanes = 16 / sizeof(X);
+                mask above{};
+                for (std::size_t j = 0; j < bTreeFanout; j += lanes) {
+                    vec keys;
+                    std::memcpy(&keys, node + j, sizeof(keys));
+                    above += x < keys;
+                }
+                std::size_t count = bTreeFanout;
+                for (std::size_t j = 0; j < lanes; ++j) count += static_cast<std::size_t>(above[j]);
+                return count;
             }
+#endif
+            std::size_t count = 0;
+            for (std::size_t j = 0; j < bTreeFanout; ++j) count += static_cast<std::size_t>(!(x < node[j]));
+            return count;
+        }
 
-            //if rightX <  x, then the interpolation point is to the right of the table.
-            //compute y = mx + b, using the last two pairs to determine that equation
-            if (x > rightX) {
-                //perform a reverse iteration.
-                auto rhead = intrpData->rbegin();
-                rightX = rhead->first;
-                rightY = rhead->second;
-                ++rhead;
-                leftX = rhead->first;
-                leftY = rhead->second;
-                return interpolateOnSegment(x);
+        //upperBound() on the B+ tree: one node per layer. x only reaches a padding slot when it is at
+        //least the padding value, and is then steered back to the last node of the layer below.
+        std::size_t bPlusTreeUpperBound(X x) const {
+            X const *keys = bTreeKeys.data();
+            std::size_t k = 0;
+            for (std::size_t h = bTreeNodes.size() - 1; h > 0; --h) {
+                std::size_t i = countNotAbove(keys + bTreeOffset[h] + k * bTreeFanout, x);
+                k = std::min(k * (bTreeFanout + 1) + i, bTreeNodes[h - 1] - 1);
             }
 
-            //simply perform linear interpolation between two points
-            return interpolate(x);
+            std::size_t first = k * bTreeFanout;
+            std::size_t n = xColumn.size();
+            if (first + bTreeFanout <= n) return first + countNotAbove(xColumn.data() + first, x);
+            while (first < n && !(x < xColumn[first])) ++first;    //the last leaf, when it isn't full
+            return first;
         }
 
-    private:
-        std::shared_ptr<std::vector<std::pair<X, Y> > > intrpData;
-        X rightX, leftX; //current left data point
-        Y rightY, leftY; //next adjacent data point
-        X precision; //how close is close enough?
-        typename std::vector<std::pair<X, Y > >::iterator head;
+        //Grid arithmetic is done in at least double precision, so integer Xs work too.
+        using wideX = std::common_type_t<X, double>;
+        bool uniform = false;
+        bool grids = true;      //false: never look for a grid
+        wideX gridOrigin = 0;
+        wideX gridScale = 0;    //1 / grid step
 
-        InterpolationResultType preflightFailed() {
-            head = intrpData->begin();
-            if (head == intrpData->end()) return InterpolationResultType::dataIncomplete;  //empty vector
+        //A table is treated as a grid when each X is within precision, and under half a step, of
+        //X0 + i * step. That keeps the computed index within one of the true one. known skips the
+        //scan for a table already found to be a grid.
+        void checkGrid(bool known) {
+            uniform = false;
+            if (tableStatus != InterpolationResultType::OK || !grids) return;
 
-            //If less then 2 pairs, then nothing can be done.
-            if (intrpData->size() < 2) return InterpolationResultType::dataIncomplete;
+            std::size_t n = xColumn.size();
+            wideX origin = static_cast<wideX>(xColumn.front());
+            wideX step = (static_cast<wideX>(xColumn.back()) - origin) / static_cast<wideX>(n - 1);
+            if (!(step > 0)) return;
 
-            head = intrpData->begin();
-            leftX = head->first;                    //start from left side of graph or top of table
-            leftY = head->second;
+            wideX tolerance = std::min(static_cast<wideX>(precision), step / 2);
+            for (std::size_t i = 0; i < n && !known; ++i) {
+                wideX expected = origin + static_cast<wideX>(i) * step;
+                if (!(std::abs(static_cast<wideX>(xColumn[i]) - expected) <= tolerance)) return;
+                if (i != 0 && !(xColumn[i - 1] < xColumn[i])) return;
+            }
+            uniform = true;
+            gridOrigin = origin;
+            gridScale = 1 / step;
+        }
 
-            return InterpolationResultType::OK;
+        //upperBound() on a grid: compute the index, then step it to the exact answer
+        std::size_t gridUpperBound(X x) const {
+            std::size_t n = xColumn.size();
+            wideX position = (static_cast<wideX>(x) - gridOrigin) * gridScale;
+
+            std::size_t rhs;
+            if (!(position < static_cast<wideX>(n))) rhs = n;    //also NaN, as upper_bound would
+            else if (position < 0) rhs = 0;
+            else rhs = static_cast<std::size_t>(position) + 1;
+
+            while (rhs < n && !(x < xColumn[rhs])) ++rhs;
+            while (rhs > 0 && x < xColumn[rhs - 1]) --rhs;
+            return rhs;
         }
 
-        std::tuple<InterpolationResultType, Y> scanVector(X x) {
-            auto currX = head->first;   //current X under consideration
-            auto next = ++head;
-            rightX = next->first;
-            rightY = next->second;
+        //SearchMethod::learned. The pairs are split into runs, each fit by a line from X to table index
+        //that is never more than learnedError off for the pairs in its run. learnedFirst holds each run's
+        //first X, so finding the run is a search over a few cache lines however large the table.
+        struct learnedRun {
+            wideX slope;
+            std::size_t start;  //index of the run's first pair
+        };
+        std::size_t learnedError = 16;
+        tableColumn<X> learnedFirst;
+        tableColumn<learnedRun> learnedRuns;
 
-            //scan pairs to determine where the desired point lies between
-            auto foundRhs = false;  //need to "peek" ahead by one to ensure sorted data
-            for (std::pair<X, Y> &item : *intrpData) {
-                if (item.first < currX) {
-                    return std::make_tuple(InterpolationResultType::dataUnsorted, 0);
-                } else {
-                    currX = item.first;
+        //Greedy fit: grow each run while some slope through its first pair keeps every pair in range.
+        //The slopes still allowed form a cone that narrows with each pair added.
+        void buildLearnedIndex() {
+            learnedFirst.clear();
+            learnedRuns.clear();
+            if (search != SearchMethod::learned || tableStatus != InterpolationResultType::OK || uniform) return;
+
+            std::size_t n = xColumn.size();
+            wideX error = static_cast<wideX>(learnedError);
+            cacheLineVector<X> firsts;
+            cacheLineVector<learnedRun> runs;
+            std::size_t start = 0;
+            while (start < n) {
+                wideX origin = static_cast<wideX>(xColumn[start]);
+                wideX lowest = 0;
+                wideX highest = std::numeric_limits<wideX>::infinity();
+                std::size_t i = start + 1;
+                for (; i < n; ++i) {
+                    wideX dx = static_cast<wideX>(xColumn[i]) - origin;
+                    wideX dy = static_cast<wideX>(i - start);
+                    if (dx == 0) {
+                        if (dy > error) break;
+                        continue;
+                    }
+                    wideX low = std::max(lowest, (dy - error) / dx);
+                    wideX high = std::min(highest, (dy + error) / dx);
+                    if (low > high) break;
+                    lowest = low;
+                    highest = high;
+                }
+                wideX slope = std::isinf(highest) ? lowest : (lowest + highest) / 2;
+                firsts.push_back(xColumn[start]);
+                runs.push_back({slope, start});
+                start = i;
+            }
+            learnedFirst.own(std::move(firsts));
+            learnedRuns.own(std::move(runs));
+        }
+
+        //upperBound() from the fit: predict, then search learnedError + 1 pairs either side. The
+        //prediction is kept inside its run, where the bound holds; should rounding still leave the
+        //answer outside the window, the whole table is searched instead.
+        std::size_t learnedUpperBound(X x) const {
+            std::size_t n = xColumn.size();
+            if (!(xColumn.front() <= x)) return x < xColumn.front() ? 0 : n;   //NaN, as upper_bound would
+
+            std::size_t run = static_cast<std::size_t>(std::upper_bound(learnedFirst.begin(), learnedFirst.end(), x) -
+                                                       learnedFirst.begin()) - 1;
+            learnedRun const &fit = learnedRuns[run];
+            std::size_t end = run + 1 < learnedRuns.size() ? learnedRuns[run + 1].start : n;
+            wideX offset = fit.slope * (static_cast<wideX>(x) - static_cast<wideX>(learnedFirst[run]));
+            wideX limit = static_cast<wideX>(end - fit.start);
+            std::size_t predicted = fit.start + static_cast<std::size_t>(offset < limit ? offset : limit);  //0 * inf is NaN
+
+            std::size_t lo = predicted > learnedError + 1 ? predicted - learnedError - 1 : 0;
+            std::size_t hi = std::min(n, predicted + learnedError + 2);
+            auto first = xColumn.begin();
+            if ((lo == 0 || !(x < xColumn[lo - 1])) && (hi == n || x < xColumn[hi])) {
+                return static_cast<std::size_t>(std::upper_bound(first + static_cast<std::ptrdiff_t>(lo),
+                                                                 first + static_cast<std::ptrdiff_t>(hi), x) - first);
+            }
+            return static_cast<std::size_t>(std::upper_bound(first, xColumn.end(), x) - first);
+        }
+
+        //SearchMethod::bucketDirectory. Bucket b covers X from bucketOrigin + b / bucketScale up to the next
+        //bucket, and the pairs in it are bucketStart[b] up to bucketStart[b + 1].
+        unsigned bucketBits = 0;
+        wideX bucketOrigin = 0;
+        wideX bucketScale = 0;  //buckets per unit of X
+        tableColumn<std::size_t> bucketStart;
+
+        unsigned maxBucketBits() const {
+            return static_cast<unsigned>(std::bit_width(xColumn.size() - 1)) + 2;
+        }
+
+        //sets bucketOrigin and bucketScale for the directory bucketBits asks for; returns its bucket count
+        std::size_t placeBuckets() {
+            unsigned bits = bucketBits != 0 ? std::min(bucketBits, maxBucketBits()) :
+                                              std::min(static_cast<unsigned>(std::bit_width(xColumn.size() - 1)), 24u);
+            std::size_t buckets = std::size_t(1) << bits;
+            bucketOrigin = static_cast<wideX>(xColumn.front());
+            wideX range = static_cast<wideX>(xColumn.back()) - bucketOrigin;
+            bucketScale = range > 0 ? static_cast<wideX>(buckets) / range : 0;
+            return buckets;
+        }
+
+        void buildBuckets() {
+            bucketStart.clear();
+            if (search != SearchMethod::bucketDirectory || tableStatus != InterpolationResultType::OK || uniform) return;
+
+            std::size_t buckets = placeBuckets();
+            cacheLineVector<std::size_t> starts(buckets + 1, 0);
+            for (X x : xColumn) ++starts[bucketOf(x, buckets - 1) + 1];
+            for (std::size_t b = 1; b <= buckets; ++b) starts[b] += starts[b - 1];
+            bucketStart.own(std::move(starts));
+        }
+
+        //Never decreases as x grows, so every pair in an earlier bucket is below x and every pair in a
+        //later one is above it, even where rounding moves a pair across a bucket edge.
+        std::size_t bucketOf(X x, std::size_t last) const {
+            wideX position = (static_cast<wideX>(x) - bucketOrigin) * bucketScale;
+            return position < static_cast<wideX>(last) ? static_cast<std::size_t>(position) : last;
+        }
+
+        //upperBound() from the directory: one bucket, searched with upper_bound
+        std::size_t bucketUpperBound(X x) const {
+            std::size_t n = xColumn.size();
+            if (x < xColumn.front()) return 0;
+            if (!(x < xColumn.back())) return n;    //also NaN, as upper_bound would
+
+            std::size_t b = bucketOf(x, bucketStart.size() - 2);
+            auto first = xColumn.begin();
+            return static_cast<std::size_t>(std::upper_bound(first + static_cast<std::ptrdiff_t>(bucketStart[b]),
+                                                             first + static_cast<std::ptrdiff_t>(bucketStart[b + 1]), x) - first);
+        }
+
+        //Search index snapshots: this header, then each index array as a 64 bit element count and
+        //its elements, each starting on a 64 byte boundary. Arrays of methods not chosen are empty.
+        //An adopted index is used where it lies, as the columns of a view are, so the header records
+        //the sizes and float format its arrays were written with and a snapshot from a build that
+        //differs is rebuilt rather than read.
+        static constexpr std::uint32_t indexSnapshotVersion = 2;
+        struct indexSnapshotHeader {
+            std::uint32_t version;
+            std::uint8_t method;
+            std::uint8_t xBytes;           //sizeof(X)
+            std::uint8_t sizeBytes;        //sizeof(std::size_t)
+            std::uint8_t runBytes;         //sizeof(learnedRun)
+            std::uint8_t wideDigits;       //std::numeric_limits<wideX>::digits, telling long double formats apart
+            std::uint8_t reserved[7];
+            std::uint64_t count;
+            std::uint64_t dataChecksum;
+            std::uint64_t indexChecksum;   //of everything after the header
+            std::uint64_t setting;         //learnedError or bucketBits
+        };
+        bool adopted = false;
+
+        //the setting the chosen method's index depends on
+        std::uint64_t indexSetting() const {
+            if (search == SearchMethod::learned) return learnedError;
+            if (search == SearchMethod::bucketDirectory) return bucketBits;
+            return 0;
+        }
+
+        void applySetting(std::uint64_t setting) {
+            if (search == SearchMethod::learned) {
+                learnedError = static_cast<std::size_t>(std::min<std::uint64_t>(setting, std::numeric_limits<std::size_t>::max()));
+            }
+            if (search == SearchMethod::bucketDirectory) {
+                bucketBits = static_cast<unsigned>(std::min<std::uint64_t>(setting, std::numeric_limits<unsigned>::max()));
+            }
+        }
+
+        static constexpr std::size_t snapshotAlignment = 64;
+
+        template<class T>
+        static void putArray(cacheLineVector<unsigned char> &snapshot, std::span<const T> values) {
+            static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= snapshotAlignment);
+            std::uint64_t count = values.size();
+            std::size_t at = (snapshot.size() + snapshotAlignment - 1) / snapshotAlignment * snapshotAlignment;
+            snapshot.resize(at + snapshotAlignment + values.size_bytes());
+            std::memcpy(snapshot.data() + at, &count, sizeof(count));
+            if (!values.empty()) std::memcpy(snapshot.data() + at + snapshotAlignment, values.data(), values.size_bytes());
+        }
+
+        //the array at or after at, moving at past it; false if it runs off the end
+        template<class T>
+        static bool getArray(std::span<const unsigned char> snapshot, std::size_t &at, std::span<const T> &values) {
+            at = (at + snapshotAlignment - 1) / snapshotAlignment * snapshotAlignment;
+            std::uint64_t count;
+            if (at > snapshot.size() || snapshot.size() - at < snapshotAlignment) return false;
+            std::memcpy(&count, snapshot.data() + at, sizeof(count));
+            at += snapshotAlignment;
+            if (count > (snapshot.size() - at) / sizeof(T)) return false;
+            values = {reinterpret_cast<T const *>(snapshot.data() + at), static_cast<std::size_t>(count)};
+            at += values.size_bytes();
+            return true;
+        }
+
+        //Take the index from a snapshot if it fits this table, checking the cheap things before
+        //the checksums. Methods that have no index don't need one. The snapshot's setting is kept
+        //even when its arrays can't be used, so a rebuilt index is tuned the same way.
+        bool adoptIndex(std::span<const unsigned char> snapshot) {
+            adopted = false;
+            bool indexed = search == SearchMethod::eytzinger || search == SearchMethod::bPlusTree ||
+                           search == SearchMethod::learned || search == SearchMethod::bucketDirectory;
+            if (snapshot.empty() || !indexed || tableStatus != InterpolationResultType::OK || uniform) return false;
+
+            indexSnapshotHeader header;
+            if (snapshot.size() < sizeof(header) || reinterpret_cast<std::uintptr_t>(snapshot.data()) % snapshotAlignment != 0) return false;
+            std::memcpy(&header, snapshot.data(), sizeof(header));
+            if (header.version != indexSnapshotVersion || header.method != static_cast<std::uint8_t>(search) ||
+                header.count != xColumn.size()) return false;
+            applySetting(header.setting);
+            if (header.xBytes != sizeof(X) || header.sizeBytes != sizeof(std::size_t) || header.runBytes != sizeof(learnedRun) ||
+                header.wideDigits != std::numeric_limits<wideX>::digits) return false;
+            if (header.indexChecksum != checksum(snapshot.data() + sizeof(header), snapshot.size() - sizeof(header))) return false;
+            if (header.dataChecksum != dataChecksum()) return false;
+
+            std::span<const X> keys, firsts, treeKeys;
+            std::span<const std::size_t> rank, nodes, offsets, starts;
+            std::span<const learnedRun> runs;
+            std::size_t at = sizeof(header);
+            bool whole = getArray(snapshot, at, keys) && getArray(snapshot, at, rank) &&
+                         getArray(snapshot, at, treeKeys) && getArray(snapshot, at, nodes) && getArray(snapshot, at, offsets) &&
+                         getArray(snapshot, at, firsts) && getArray(snapshot, at, runs) && getArray(snapshot, at, starts);
+            if (!whole) return false;
+            eytzingerKeys.borrow(keys);
+            eytzingerRank.borrow(rank);
+            bTreeKeys.borrow(treeKeys);
+            bTreeNodes.assign(nodes.begin(), nodes.end());
+            bTreeOffset.assign(offsets.begin(), offsets.end());
+            learnedFirst.borrow(firsts);
+            learnedRuns.borrow(runs);
+            bucketStart.borrow(starts);
+            if (!indexFits()) return false;     //buildIndexes() replaces the lot
+            adopted = true;
+            return true;
+        }
+
+        //The chosen method's arrays have the sizes this table and setting give them, and every
+        //position they hold lies inside the table, so searching them can't read past either. That
+        //the checksums matched says the bytes are the ones saved; this says they were saved for
+        //a table like this one.
+        bool indexFits() {
+            std::size_t n = xColumn.size();
+            if (search == SearchMethod::eytzinger) {
+                return eytzingerKeys.size() == n + 1 && eytzingerRank.size() == n + 1 &&
+                       std::all_of(eytzingerRank.begin() + 1, eytzingerRank.end(), [n](std::size_t r) { return r < n; });
+            }
+            if (search == SearchMethod::bPlusTree) {
+                std::vector<std::size_t> nodes, offsets;
+                std::size_t total = bTreeShape(n, nodes, offsets);
+                return nodes == bTreeNodes && offsets == bTreeOffset && bTreeKeys.size() == total;
+            }
+            if (search == SearchMethod::learned) {
+                std::size_t runs = learnedRuns.size();
+                if (runs == 0 || learnedFirst.size() != runs || learnedRuns[0].start != 0) return false;
+                for (std::size_t r = 0; r < runs; ++r) {
+                    std::size_t end = r + 1 < runs ? learnedRuns[r + 1].start : n;
+                    if (!(learnedRuns[r].start < end) || !(learnedRuns[r].slope >= 0) ||
+                        learnedFirst[r] != xColumn[learnedRuns[r].start]) return false;
                 }
-                if (x == leftX) return std::make_tuple(InterpolationResultType::exactMatch, leftY);
-                if (x == rightX) return std::make_tuple(InterpolationResultType::exactMatch, rightY);
-
-                if (item.first > x) {    //we have the rhs
-                    //This flag looks ahead by one item. If the 'dataUnsorted' hasn't been tripped, exit the loop.
-                    if (foundRhs) {
-                        break;
-                    } else {
-                        rightX = item.first;
-                        rightY = item.second;
-                        foundRhs = true;
+                return true;
+            }
+            if (search == SearchMethod::bucketDirectory) {
+                std::size_t buckets = placeBuckets();
+                return bucketStart.size() == buckets + 1 && bucketStart[0] == 0 && bucketStart[buckets] == n &&
+                       std::is_sorted(bucketStart.begin(), bucketStart.end());
+            }
+            return false;
+        }
+
+        //SearchMethod::interpolationSearch gives up guessing after this many probes
+        static constexpr int interpolationProbes = 8;
+
+        //upperBound() by interpolation search. X[lo] <= x < X[hi] throughout, so each guess divides by
+        //a positive width and lands strictly inside the range.
+        std::size_t interpolationUpperBound(X x) const {
+            std::size_t n = xColumn.size();
+            if (x < xColumn.front()) return 0;
+            if (!(x < xColumn.back())) return n;    //also NaN, as upper_bound would
+
+            std::size_t lo = 0;
+            std::size_t hi = n - 1;
+            for (int probe = 0; probe < interpolationProbes && hi - lo > 1; ++probe) {
+                wideX left = static_cast<wideX>(xColumn[lo]);
+                wideX fraction = (static_cast<wideX>(x) - left) / (static_cast<wideX>(xColumn[hi]) - left);
+                std::size_t guess = lo + static_cast<std::size_t>(fraction * static_cast<wideX>(hi - lo));
+                guess = std::clamp(guess, lo + 1, hi - 1);
+                if (x < xColumn[guess]) hi = guess;
+                else lo = guess;
+            }
+            auto first = xColumn.begin();
+            return static_cast<std::size_t>(std::upper_bound(first + static_cast<std::ptrdiff_t>(lo + 1),
+                                                             first + static_cast<std::ptrdiff_t>(hi), x) - first);
+        }
+
+        //index of the first pair whose X is greater than x; size() when there is none
+        std::size_t upperBound(X x) const {
+            if (uniform && search != SearchMethod::linearScan) return gridUpperBound(x);
+            if (search == SearchMethod::learned) return learnedUpperBound(x);
+            if (search == SearchMethod::interpolationSearch) return interpolationUpperBound(x);
+            if (search == SearchMethod::bucketDirectory) return bucketUpperBound(x);
+            return comparingUpperBound(x);
+        }
+
+        //upperBound() for the methods that only compare Xs; the rest bisect
+        std::size_t comparingUpperBound(X x) const {
+            auto first = xColumn.begin();
+            auto last = xColumn.end();
+            if (search == SearchMethod::linearScan) {
+                return static_cast<std::size_t>(std::find_if(first, last, [x](X item) { return item > x; }) - first);
+            }
+            if (search == SearchMethod::eytzinger) return eytzingerUpperBound(x);
+            if (search == SearchMethod::bPlusTree) return bPlusTreeUpperBound(x);
+            return static_cast<std::size_t>(std::upper_bound(first, last, x) - first);
+        }
+
+        std::tuple<InterpolationResultType, Y> nearestOf(X x, segment where) const {
+            switch (where.result) {
+                case InterpolationResultType::lessThanData:     //the 1st X is the closest
+                    return {InterpolationResultType::lessThanData, yColumn.front()};
+                case InterpolationResultType::exactMatch:
+                    return {InterpolationResultType::OK, yColumn[where.index]};
+                case InterpolationResultType::greaterThanData:  //the last X is the closest
+                    return {InterpolationResultType::greaterThanData, yColumn.back()};
+                default:
+                    return closerOf(x, point(where.index - 1), point(where.index));
+            }
+        }
+
+        std::tuple<InterpolationResultType, Y> interpolationOf(X x, segment where) const {
+            if (where.result == InterpolationResultType::exactMatch) {
+                return {InterpolationResultType::OK, yColumn[where.index]};
+            }
+            if (compiled) return evaluateSegment(x, where.index);
+
+            switch (where.result) {
+                //x is to the left of the table. compute y = mx + b, using the 1st two pairs to determine that equation
+                case InterpolationResultType::lessThanData:
+                    return interpolateOnSegment(x, point(0), point(1));
+                //x is to the right of the table. compute y = mx + b, using the last two pairs
+                case InterpolationResultType::greaterThanData:
+                    return interpolateOnSegment(x, point(xColumn.size() - 2), point(xColumn.size() - 1));
+                //simply perform linear interpolation between two points
+                default:
+                    return interpolate(x, point(where.index - 1), point(where.index));
+            }
+        }
+
+        static void store(std::span<Y> ys, std::span<InterpolationResultType> results, std::size_t i,
+                          std::tuple<InterpolationResultType, Y> const &answer) {
+            ys[i] = std::get<1>(answer);
+            if (!results.empty()) results[i] = std::get<0>(answer);
+        }
+
+        //Finds each x's segment and hands it to visit(i, x, segment).
+        template<class Visit>
+        InterpolationResultType batch(std::span<const X> xs, std::span<Y> ys, std::span<InterpolationResultType> results,
+                                      QueryOrder order, Visit visit) const {
+            bool wantResults = !results.empty();
+            if (ys.size() < xs.size() || (wantResults && results.size() < xs.size())) {
+                return InterpolationResultType::dataIncomplete;
+            }
+
+            if (tableStatus != InterpolationResultType::OK) {
+                std::fill_n(ys.begin(), xs.size(), Y(0));
+                if (wantResults) std::fill_n(results.begin(), xs.size(), tableStatus);
+                return tableStatus;
+            }
+
+            if (order == QueryOrder::detect) {
+                //written as !(a <= b) so a NaN anywhere sends the batch down the unordered path
+                bool ascending = std::adjacent_find(xs.begin(), xs.end(), [](X a, X b) { return !(a <= b); }) == xs.end();
+                order = ascending ? QueryOrder::ascending : QueryOrder::unordered;
+            }
+
+            if (order == QueryOrder::ascending) {
+                //merge walk: each x's upper bound is at or after the previous one. Galloping rather
+                //than stepping keeps a short batch over a long table from walking all of it.
+                std::size_t rhs = 0;
+                for (std::size_t i = 0; i < xs.size(); ++i) {
+                    rhs = gallop(xs[i], rhs);
+                    visit(i, xs[i], classify(xs[i], rhs));
+                }
+                return tableStatus;
+            }
+
+            for (std::size_t i = 0; i < xs.size(); ++i) visit(i, xs[i], locate(xs[i]));
+            return tableStatus;
+        }
+
+        //getY() or nearestY() batch: segments are found as usual, then evaluated a block at a time by
+        //a SIMD kernel. nearestY() knows each point's result as soon as its segment is found.
+        template<simd::answer a>
+        InterpolationResultType simdBatch(std::span<const X> xs, std::span<Y> ys, std::span<InterpolationResultType> results,
+                                          QueryOrder order, simd::instructionSet isa) const {
+            simd::block<X> lanes{};
+            lanes.precision = precision;
+            std::size_t start = 0;
+            std::size_t filled = 0;
+
+            auto flush = [&]() {
+                simd::evaluate(isa, filled, lanes, a);
+                for (std::size_t j = 0; j < filled; ++j) {
+                    ys[start + j] = lanes.y[j];
+                    if (a == simd::answer::interpolated && !results.empty()) {
+                        results[start + j] = lanes.divideByZero[j] ? InterpolationResultType::divideByZero
+                                                                   : InterpolationResultType::OK;
+                    }
+                }
+                start += filled;
+                filled = 0;
+            };
+
+            InterpolationResultType status = batch(xs, ys, results, order, [&](std::size_t i, X x, segment where) {
+                std::size_t lhs = where.index - 1;
+                std::size_t rhs = where.index;
+                lanes.exact[filled] = 0;
+                lanes.extrapolate[filled] = 0;
+                if constexpr (a == simd::answer::nearest) {
+                    //off either end, the end pair's Y is the answer, as it is for an exact match
+                    if (where.result == InterpolationResultType::lessThanData) rhs = 0;
+                    if (where.result == InterpolationResultType::greaterThanData) rhs = xColumn.size() - 1;
+                    if (where.result != InterpolationResultType::OK) {
+                        lanes.exact[filled] = -1;
+                        lhs = rhs;
+                    }
+                    if (!results.empty()) {
+                        results[i] = where.result == InterpolationResultType::exactMatch ? InterpolationResultType::OK
+                                                                                         : where.result;
                     }
                 } else {
-                    leftX = item.first;
-                    leftY = item.second;
+                    switch (where.result) {
+                        case InterpolationResultType::exactMatch:
+                            lanes.exact[filled] = -1;
+                            lhs = rhs;
+                            break;
+                        case InterpolationResultType::lessThanData:
+                            lanes.extrapolate[filled] = -1;
+                            lhs = 0;
+                            rhs = 1;
+                            break;
+                        case InterpolationResultType::greaterThanData:
+                            lanes.extrapolate[filled] = -1;
+                            lhs = xColumn.size() - 2;
+                            rhs = xColumn.size() - 1;
+                            break;
+                        default:
+                            break;
+                    }
                 }
+                lanes.x[filled] = x;
+                lanes.leftX[filled] = xColumn[lhs];
+                lanes.leftY[filled] = yColumn[lhs];
+                lanes.rightX[filled] = xColumn[rhs];
+                lanes.rightY[filled] = yColumn[rhs];
+                if (++filled == lanes.size) flush();
+            });
+            if (filled != 0) flush();
+            return status;
+        }
+
+        //upperBound(x), searching outwards from a previous upper bound in steps of 1, 2, 4, ...
+        std::size_t gallop(X x, std::size_t hint) const {
+            std::size_t n = xColumn.size();
+            auto first = xColumn.begin();
+            hint = std::min(hint, n);   //the table may have been re-validated shorter
+
+            if (hint < n && !(x < xColumn[hint])) {    //moved right
+                std::size_t lo = hint + 1;
+                std::size_t step = 1;
+                while (hint + step < n && !(x < xColumn[hint + step])) {
+                    lo = hint + step + 1;
+                    step *= 2;
+                }
+                std::size_t hi = std::min(hint + step, n);
+                return static_cast<std::size_t>(std::upper_bound(first + lo, first + hi, x) - first);
+            }
+
+            if (hint > 0 && x < xColumn[hint - 1]) {    //moved left
+                std::size_t hi = hint - 1;
+                std::size_t step = 1;
+                while (step <= hi && x < xColumn[hi - step]) {
+                    hi -= step;
+                    step *= 2;
+                }
+                std::size_t lo = (step <= hi) ? hi - step + 1 : 0;
+                return static_cast<std::size_t>(std::upper_bound(first + lo, first + hi, x) - first);
+            }
+
+            return hint;    //same segment as last time
+        }
+
+        segment locate(X x) const {
+            return classify(x, upperBound(x));
+        }
+
+        //rhs is the index of the first pair whose X is greater than x
+        segment classify(X x, std::size_t rhs) const {
+            if (rhs == 0) return {InterpolationResultType::lessThanData, 0};
+
+            if (xColumn[rhs - 1] == x) {
+                //An exact hit reports the first of any equal Xs. The last pair only counts as
+                //an exact hit when it is also the 2nd pair.
+                std::size_t lhs = rhs - 1;
+                while (duplicates && lhs != 0 && xColumn[lhs - 1] == x) --lhs;
+                if (lhs != xColumn.size() - 1 || xColumn.size() == 2) return {InterpolationResultType::exactMatch, lhs};
             }
-            return std::make_tuple(InterpolationResultType::OK, 0); //just return OK, caller will examine state
+
+            if (rhs == xColumn.size()) return {InterpolationResultType::greaterThanData, rhs};
+            return {InterpolationResultType::OK, rhs};
+        }
+
+        std::tuple<InterpolationResultType, Y> evaluateSegment(X x, std::size_t index) const {
+            segmentCoefficients const &coefficients = segments[index];
+            if (coefficients.status != InterpolationResultType::OK) return {coefficients.status, 0};
+            return {InterpolationResultType::OK, multiplyAdd(coefficients.slope, static_cast<Y>(x), coefficients.intercept)};
         }
 
-        std::tuple<InterpolationResultType, Y> interpolate(X x) {
-            std::tuple<simpleTools::InterpolationResultType, Y> result = computeSlope();
+        //fabs() and precision as the arithmetic has always seen them: every X goes through double
+        //for fabs(), and integer precisions, 64 bit ones included, divide as double
+        static double magnitude(X value) {
+            return fabs(static_cast<double>(value));
+        }
+
+        auto precisionDivisor() const {
+            if constexpr (std::is_integral_v<X>) return static_cast<double>(precision);
+            else return precision;
+        }
+
+        //find the closest X to x and return that Y
+        std::tuple<InterpolationResultType, Y> closerOf(X x, std::pair<X, Y> const &lhs, std::pair<X, Y> const &rhs) const {
+            X leftDelta = static_cast<X>(magnitude(x - lhs.first) / precisionDivisor());
+            X rightDelta = static_cast<X>(magnitude(x - rhs.first) / precisionDivisor());
+            if (int(leftDelta) < int(rightDelta)) {
+                return {InterpolationResultType::OK, lhs.second};
+            }
+            return {InterpolationResultType::OK, rhs.second};
+        }
+
+        static std::tuple<InterpolationResultType, Y> interpolate(X x, std::pair<X, Y> const &lhs, std::pair<X, Y> const &rhs) {
+            std::tuple<simpleTools::InterpolationResultType, Y> result = computeSlope(lhs.first, lhs.second, rhs.first, rhs.second);
             if (std::get<0>(result) == InterpolationResultType::divideByZero) {
                 return result;
             }
 
             Y slope = std::get<1>(result);
 
-            return std::make_tuple(InterpolationResultType::OK, leftY + (x - leftX) * slope);
+            auto step = simd::unfused((x - lhs.first) * slope);
+            return std::make_tuple(InterpolationResultType::OK, lhs.second + step);
         }
 
-        std::tuple<InterpolationResultType, Y> interpolateOnSegment(X x) {   // y = mx + b
-            std::tuple<simpleTools::InterpolationResultType, Y> result = computeSlope();
+        static std::tuple<InterpolationResultType, Y> interpolateOnSegment(X x, std::pair<X, Y> const &lhs, std::pair<X, Y> const &rhs) {   // y = mx + b
+            std::tuple<simpleTools::InterpolationResultType, Y> result = computeSlope(lhs.first, lhs.second, rhs.first, rhs.second);
             if (std::get<0>(result) == InterpolationResultType::divideByZero) {
                 return result;
             }
             Y m = std::get<1>(result);
-            Y b = leftY - m * leftX;
+            Y b = static_cast<Y>(lhs.second - simd::unfused(m * lhs.first));
 
-            return std::make_tuple(InterpolationResultType::OK, m * x + b);
+            return std::make_tuple(InterpolationResultType::OK, simd::unfused(m * x) + b);
         }
 
-        std::tuple<InterpolationResultType, Y> computeSlope() const {
+        static std::tuple<InterpolationResultType, Y> computeSlope(X leftX, Y leftY, X rightX, Y rightY) {
             X denominator = rightX - leftX;
 
-            if (static_cast<X> (fabs(static_cast<X> (denominator))) < static_cast<X> (0.0001)) {
+            if (static_cast<X> (magnitude(static_cast<X> (denominator))) < static_cast<X> (0.0001)) {
                 return {InterpolationResultType::divideByZero, 0};
             }
 
             return std::make_tuple(InterpolationResultType::OK, static_cast<Y> ((rightY - leftY) / denominator));
         }
+
+    public:
+        //Remembers where its last query landed and gallops out from there, so a stream of x values
+        //that drifts slowly costs O(1) a query and a jump costs O(log distance). A cursor is cheap;
+        //give each stream its own and share the table. Results match the table's own getY()/nearestY().
+        class cursor {
+        public:
+            explicit cursor(interpolation const &t) : intrp(&t) {}
+
+            std::tuple<InterpolationResultType, Y> nearestY(X x) {
+                if (intrp->tableStatus != InterpolationResultType::OK) return {intrp->tableStatus, 0};
+                return intrp->nearestOf(x, seek(x));
+            }
+
+            std::tuple<InterpolationResultType, Y> getY(X x) {
+                if (intrp->tableStatus != InterpolationResultType::OK) return {intrp->tableStatus, 0};
+                return intrp->interpolationOf(x, seek(x));
+            }
+
+        private:
+            interpolation const *intrp;
+            std::size_t hint = 0;   //upper bound found by the last query
+
+            segment seek(X x) {
+                hint = intrp->gallop(x, hint);
+                return intrp->classify(x, hint);
+            }
+        };
+    };
+
+    //Fixed point formats for fixedPointInterpolation. A raw value is the number times 2^fractionBits;
+    //products are formed in wide, twice raw's width.
+    struct q16_16 {
+        using raw = std::int32_t;
+        using wide = std::int64_t;
+        using unsignedWide = std::uint64_t;
+        static constexpr int fractionBits = 16;
+
+        static constexpr raw fromDouble(double value) {
+            return static_cast<raw>(value * (1 << fractionBits) + (value < 0 ? -0.5 : 0.5));
+        }
+        static constexpr double toDouble(raw value) { return static_cast<double>(value) / (1 << fractionBits); }
+    };
+
+#if defined(__SIZEOF_INT128__)
+    struct q32_32 {
+        using raw = std::int64_t;
+        __extension__ typedef __int128 wide;
+        __extension__ typedef unsigned __int128 unsignedWide;
+        static constexpr int fractionBits = 32;
+
+        static constexpr raw fromDouble(double value) {
+            return static_cast<raw>(value * (1LL << fractionBits) + (value < 0 ? -0.5 : 0.5));
+        }
+        static constexpr double toDouble(raw value) { return static_cast<double>(value) / (1LL << fractionBits); }
+    };
+#endif
+
+    //Linear interpolation in fixed point, for targets without fast floating point. X and Y are raw
+    //Q values (Q::fromDouble() converts). Each segment's slope is worked out once, as a mantissa and a
+    //shift, so getY() is two integer multiplies, a rounding shift and an add. Results off the ends of the
+    //representable range saturate. Checks and search are interpolation<raw, raw>'s, kept to integer
+    //compares: evenly spaced tables aren't treated as grids, and the learned, interpolationSearch and
+    //bucketDirectory methods, which estimate positions in floating point, fall back to binarySearch.
+    template<class Q>
+    class fixedPointInterpolation {
+    public:
+        using raw = typename Q::raw;
+
+        explicit fixedPointInterpolation(std::shared_ptr<std::vector<std::pair<raw, raw> > > const a, raw p,
+                                         SearchMethod s = SearchMethod::binarySearch) :
+            table(a, p, comparing(s), false) {
+            fitSlopes();
+        }
+
+        InterpolationResultType validate() {
+            table.validate();
+            fitSlopes();
+            return table.status();
+        }
+
+        SearchMethod searchMethod() const { return table.searchMethod(); }
+
+        //The closest Y to x, chosen as interpolation's nearestY() chooses: distances are divided by
+        //the precision and truncated, and a tie goes to the right.
+        std::tuple<InterpolationResultType, raw> nearestY(raw x) const {
+            if (table.status() != InterpolationResultType::OK) return {table.status(), 0};
+
+            std::span<const raw> xs = table.xValues();
+            std::span<const raw> ys = table.yValues();
+            std::size_t rhs = table.comparingUpperBound(x);
+            if (rhs == 0) return {InterpolationResultType::lessThanData, ys.front()};
+            std::size_t hit = exactHit(x, rhs);
+            if (hit != xs.size()) return {InterpolationResultType::OK, ys[hit]};
+            if (rhs == xs.size()) return {InterpolationResultType::greaterThanData, ys.back()};
+
+            unsignedWide step = table.getPrecision() > 0 ? static_cast<unsignedWide>(table.getPrecision()) : 1;
+            unsignedWide left = static_cast<unsignedWide>(static_cast<wide>(x) - xs[rhs - 1]) / step;
+            unsignedWide right = static_cast<unsignedWide>(static_cast<wide>(xs[rhs]) - x) / step;
+            return {InterpolationResultType::OK, left < right ? ys[rhs - 1] : ys[rhs]};
+        }
+
+        std::tuple<InterpolationResultType, raw> getY(raw x) const {
+            if (table.status() != InterpolationResultType::OK) return {table.status(), 0};
+
+            std::span<const raw> xs = table.xValues();
+            std::span<const raw> ys = table.yValues();
+            std::size_t n = xs.size();
+            std::size_t rhs = table.comparingUpperBound(x);
+            std::size_t hit = exactHit(x, rhs);
+            if (hit != n) return {InterpolationResultType::OK, ys[hit]};
+
+            slope const &m = slopes[rhs];
+            if (m.divideByZero) return {InterpolationResultType::divideByZero, 0};
+            std::size_t lhs = rhs == 0 ? 0 : std::min(rhs - 1, n - 2);  //off either end: the nearest two pairs
+
+            bool below = x < xs[lhs];
+            unsignedWide distance = below ? static_cast<unsignedWide>(static_cast<wide>(xs[lhs]) - x)
+                                          : static_cast<unsignedWide>(static_cast<wide>(x) - xs[lhs]);
+            unsignedWide change = scale(m, distance);
+
+            wide y = ys[lhs];
+            if (m.negative != below) {
+                unsignedWide room = static_cast<unsignedWide>(y - std::numeric_limits<raw>::min());
+                return {InterpolationResultType::OK, change > room ? std::numeric_limits<raw>::min()
+                                                                   : static_cast<raw>(y - static_cast<wide>(change))};
+            }
+            unsignedWide room = static_cast<unsignedWide>(std::numeric_limits<raw>::max() - y);
+            return {InterpolationResultType::OK, change > room ? std::numeric_limits<raw>::max()
+                                                               : static_cast<raw>(y + static_cast<wide>(change))};
+        }
+
+    private:
+        using wide = typename Q::wide;
+        using unsignedWide = typename Q::unsignedWide;
+        using unsignedRaw = std::make_unsigned_t<raw>;
+        static constexpr int rawBits = std::numeric_limits<raw>::digits + 1;
+        static constexpr unsignedWide lowMask = (unsignedWide(1) << rawBits) - 1;
+
+        //|slope| = (high * 2^rawBits + low) / 2^shift. The mantissa has 2 * rawBits - 1 significant bits,
+        //so it is off by under one part in 2^(2 * rawBits - 2) and the rounding in getY() is all that's
+        //left. Any distance between two raw values is under 2^rawBits, so each half's product with one
+        //fits in unsignedWide.
+        struct slope {
+            unsignedRaw high;
+            unsignedRaw low;
+            int shift;
+            bool negative;
+            bool divideByZero;
+        };
+        interpolation<raw, raw> table;
+        //slopes[i] spans pairs i-1 and i; slopes[0] and slopes[n] extrapolate off either end
+        std::vector<slope> slopes;
+
+        static SearchMethod comparing(SearchMethod s) {
+            switch (s) {
+                case SearchMethod::learned:
+                case SearchMethod::interpolationSearch:
+                case SearchMethod::bucketDirectory:
+                    return SearchMethod::binarySearch;
+                default:
+                    return s;
+            }
+        }
+
+        //the pair x hits, by interpolation's rules, given rhs, the first pair whose X is greater;
+        //size() when it's no hit
+        std::size_t exactHit(raw x, std::size_t rhs) const {
+            std::span<const raw> xs = table.xValues();
+            std::size_t n = xs.size();
+            if (rhs == 0 || xs[rhs - 1] != x) return n;
+            std::size_t hit = rhs - 1;
+            while (table.hasDuplicates() && hit != 0 && xs[hit - 1] == x) --hit;
+            return hit != n - 1 || n == 2 ? hit : n;
+        }
+
+        void fitSlopes() {
+            slopes.clear();
+            if (table.status() != InterpolationResultType::OK) return;
+
+            std::size_t n = table.xValues().size();
+            slopes.reserve(n + 1);
+            slopes.push_back(fitSlope(0));
+            for (std::size_t i = 1; i < n; ++i) slopes.push_back(fitSlope(i - 1));
+            slopes.push_back(fitSlope(n - 2));
+        }
+
+        //|slope| * distance, rounded to the nearest raw unit; anything over 2^rawBits means the result
+        //saturates and may be returned as just 2^rawBits.
+        static unsignedWide scale(slope const &m, unsignedWide distance) {
+            unsignedWide low = static_cast<unsignedWide>(m.low) * distance;
+            unsignedWide sum = static_cast<unsignedWide>(m.high) * distance + (low >> rawBits);  //product >> rawBits
+            low &= lowMask;
+            constexpr unsignedWide saturated = unsignedWide(1) << rawBits;
+            if (m.shift < rawBits) {
+                if (sum >> m.shift != 0) return saturated;
+                unsignedWide half = m.shift == 0 ? 0 : (low >> (m.shift - 1)) & 1;
+                return (sum << (rawBits - m.shift)) + (low >> m.shift) + half;
+            }
+            int down = m.shift - rawBits;
+            unsignedWide half = down == 0 ? low >> (rawBits - 1) : (sum >> (down - 1)) & 1;
+            return (sum >> down) + half;
+        }
+
+        //Long division, one bit at a time, until the mantissa holds 2 * rawBits - 1 significant bits,
+        //then rounded to nearest on what's left of the remainder.
+        slope fitSlope(std::size_t lhs) const {
+            //the floating point check, |dx| < 0.0001, in raw units
+            constexpr unsignedWide tooClose = static_cast<unsignedWide>(0.0001 * static_cast<double>(unsignedWide(1) << Q::fractionBits));
+            std::span<const raw> xs = table.xValues();
+            std::span<const raw> ys = table.yValues();
+            unsignedWide run = static_cast<unsignedWide>(static_cast<wide>(xs[lhs + 1]) - xs[lhs]);
+            if (run <= tooClose) return {0, 0, 0, false, true};
+
+            wide difference = static_cast<wide>(ys[lhs + 1]) - ys[lhs];
+            unsignedWide rise = static_cast<unsignedWide>(difference < 0 ? -difference : difference);
+            unsignedWide quotient = rise / run;
+            unsignedWide remainder = rise % run;
+            int shift = 0;
+            constexpr unsignedWide limit = unsignedWide(1) << (2 * rawBits - 2);
+            constexpr int maxShift = 3 * rawBits;     //enough for a rise of 1 over the widest run
+            while (quotient < limit && shift < maxShift) {
+                remainder <<= 1;
+                quotient <<= 1;
+                if (remainder >= run) {
+                    remainder -= run;
+                    quotient |= 1;
+                }
+                ++shift;
+            }
+            if (remainder >= run - remainder) ++quotient;
+            if (quotient >> (2 * rawBits - 1) != 0) {  //rounding carried into a new bit
+                quotient >>= 1;
+                --shift;
+            }
+            return {static_cast<unsignedRaw>(quotient >> rawBits), static_cast<unsignedRaw>(quotient & lowMask), shift,
+                    difference < 0, false};
+        }
+    };
+
+    //Cubic interpolation: a smooth curve through every pair, so a table can be much sparser than
+    //linear getY() needs for the same accuracy. Each segment's cubic is worked out when the table is
+    //validated (for a spline, by one O(n) tridiagonal solve), so getY() is a search plus a Horner
+    //evaluation. Off either end the curve carries on in a straight line at its end slope. Checks,
+    //search and nearestY() are interpolation<X, Y>'s; a table with repeated X has no curve, and its
+    //getY() gives divideByZero.
+    template<class X, class Y>
+    class splineInterpolation {
+        static_assert(std::is_floating_point_v<Y>, "spline coefficients need a floating point Y");
+
+    public:
+        //SplineType::clamped needs the end slopes of the constructors below; without them status()
+        //and getY() give dataIncomplete
+        explicit splineInterpolation(std::shared_ptr<std::vector<std::pair<X, Y> > > const a, X p,
+                                     SplineType t = SplineType::natural, SearchMethod s = SearchMethod::binarySearch) :
+            table(a, p, s),
+            type(t) {
+            fitCubics();
+        }
+
+        //SplineType::clamped, the curve leaving the first pair at startSlope and reaching the last at endSlope
+        explicit splineInterpolation(std::shared_ptr<std::vector<std::pair<X, Y> > > const a, X p,
+                                     Y startSlope, Y endSlope, SearchMethod s = SearchMethod::binarySearch) :
+            table(a, p, s),
+            type(SplineType::clamped),
+            endSlopes(std::array<Y, 2>{startSlope, endSlope}) {
+            fitCubics();
+        }
+
+        //views of X and Y arrays the caller owns, as with interpolation
+        explicit splineInterpolation(std::span<const X> xs, std::span<const Y> ys, X p,
+                                     SplineType t = SplineType::natural, SearchMethod s = SearchMethod::binarySearch) :
+            table(xs, ys, p, s),
+            type(t) {
+            fitCubics();
+        }
+
+        explicit splineInterpolation(std::span<const X> xs, std::span<const Y> ys, X p,
+                                     Y startSlope, Y endSlope, SearchMethod s = SearchMethod::binarySearch) :
+            table(xs, ys, p, s),
+            type(SplineType::clamped),
+            endSlopes(std::array<Y, 2>{startSlope, endSlope}) {
+            fitCubics();
+        }
+
+        InterpolationResultType validate() {
+            table.validate();
+            fitCubics();
+            return status();
+        }
+
+        InterpolationResultType status() const {
+            if (table.status() != InterpolationResultType::OK) return table.status();
+            if (type == SplineType::clamped && !endSlopes) return InterpolationResultType::dataIncomplete;
+            if (table.hasDuplicates()) return InterpolationResultType::divideByZero;
+            return InterpolationResultType::OK;
+        }
+
+        std::tuple<InterpolationResultType, Y> nearestY(X x) const { return table.nearestY(x); }
+
+        std::tuple<InterpolationResultType, Y> getY(X x) const {
+            InterpolationResultType verdict = status();
+            if (verdict != InterpolationResultType::OK) return {verdict, 0};
+            return {InterpolationResultType::OK, evaluate(x, table.bracket(x))};
+        }
+
+        //Batch form, as interpolation's: one result per x in ys, and in results when it is given,
+        //without allocating. Ascending batches search from each x's segment to the next.
+        InterpolationResultType getY(std::span<const X> xs, std::span<Y> ys,
+                                     std::span<InterpolationResultType> results = {},
+                                     QueryOrder order = QueryOrder::detect) const {
+            bool wantResults = !results.empty();
+            if (ys.size() < xs.size() || (wantResults && results.size() < xs.size())) {
+                return InterpolationResultType::dataIncomplete;
+            }
+
+            InterpolationResultType verdict = status();
+            if (wantResults) std::fill_n(results.begin(), xs.size(), verdict);
+            if (verdict != InterpolationResultType::OK) {
+                std::fill_n(ys.begin(), xs.size(), Y(0));
+                return verdict;
+            }
+
+            if (order == QueryOrder::detect) {
+                bool ascending = std::adjacent_find(xs.begin(), xs.end(), [](X a, X b) { return !(a <= b); }) == xs.end();
+                order = ascending ? QueryOrder::ascending : QueryOrder::unordered;
+            }
+            if (order == QueryOrder::ascending) {
+                std::size_t rhs = 0;
+                for (std::size_t i = 0; i < xs.size(); ++i) {
+                    rhs = table.bracket(xs[i], rhs);
+                    ys[i] = evaluate(xs[i], rhs);
+                }
+            } else {
+                for (std::size_t i = 0; i < xs.size(); ++i) ys[i] = evaluate(xs[i], table.bracket(xs[i]));
+            }
+            return verdict;
+        }
+
+    private:
+        using wide = std::common_type_t<X, Y, double>;
+
+        //y = a + t * (b + t * (c + t * d)), t being x less the X the segment starts at
+        struct cubic {
+            Y a;
+            Y b;
+            Y c;
+            Y d;
+        };
+        interpolation<X, Y> table;
+        SplineType type;
+        std::optional<std::array<Y, 2> > endSlopes;   //SplineType::clamped's
+        //cubics[i] spans pairs i-1 and i; cubics[0] and cubics[n] are the straight lines off either end
+        std::vector<cubic> cubics;
+
+        Y evaluate(X x, std::size_t rhs) const {
+            cubic const &k = cubics[rhs];
+            Y t = static_cast<Y>(static_cast<wide>(x) - static_cast<wide>(table.xValues()[rhs == 0 ? 0 : rhs - 1]));
+            return k.a + t * (k.b + t * (k.c + t * k.d));
+        }
+
+        void fitCubics() {
+            cubics.clear();
+            if (status() != InterpolationResultType::OK) return;
+
+            std::span<const X> xs = table.xValues();
+            std::size_t n = xs.size();
+            std::vector<wide> h(n - 1);
+            std::vector<wide> secant(n - 1);
+            for (std::size_t i = 0; i + 1 < n; ++i) {
+                h[i] = static_cast<wide>(xs[i + 1]) - static_cast<wide>(xs[i]);
+                secant[i] = (static_cast<wide>(table.yValues()[i + 1]) - static_cast<wide>(table.yValues()[i])) / h[i];
+            }
+            if (type == SplineType::monotone) fitHermite(h, secant, monotoneSlopes(h, secant));
+            else fitSpline(h, secant);
+        }
+
+        //Solves for c, half the curve's second derivative at each pair, by the Thomas algorithm. The
+        //forward sweep reduces row i to c[i] + upper[i] * c[i + 1] = r, storing r in c[i]; the back
+        //substitution then finishes c. Natural ends have c = 0; clamped ends get a row fixing the slope.
+        void fitSpline(std::vector<wide> const &h, std::vector<wide> const &secant) {
+            std::span<const Y> ys = table.yValues();
+            std::size_t n = ys.size();
+            bool clamped = type == SplineType::clamped;
+            std::vector<wide> upper(n);
+            std::vector<wide> c(n);
+            wide diagonal = clamped ? 2 * h[0] : 1;
+            upper[0] = clamped ? h[0] / diagonal : 0;
+            c[0] = clamped ? 3 * (secant[0] - static_cast<wide>((*endSlopes)[0])) / diagonal : 0;
+            for (std::size_t i = 1; i + 1 < n; ++i) {
+                diagonal = 2 * (h[i - 1] + h[i]) - h[i - 1] * upper[i - 1];
+                upper[i] = h[i] / diagonal;
+                c[i] = (3 * (secant[i] - secant[i - 1]) - h[i - 1] * c[i - 1]) / diagonal;
+            }
+            if (clamped) {
+                diagonal = 2 * h[n - 2] - h[n - 2] * upper[n - 2];
+                c[n - 1] = (3 * (static_cast<wide>((*endSlopes)[1]) - secant[n - 2]) - h[n - 2] * c[n - 2]) / diagonal;
+            } else {
+                c[n - 1] = 0;
+            }
+            for (std::size_t i = n - 1; i > 0; --i) c[i - 1] -= upper[i - 1] * c[i];
+
+            cubics.reserve(n + 1);
+            wide startSlope = secant[0] - h[0] * (2 * c[0] + c[1]) / 3;
+            cubics.push_back({ys[0], static_cast<Y>(startSlope), 0, 0});
+            for (std::size_t i = 0; i + 1 < n; ++i) {
+                wide b = secant[i] - h[i] * (2 * c[i] + c[i + 1]) / 3;
+                wide d = (c[i + 1] - c[i]) / (3 * h[i]);
+                cubics.push_back({ys[i], static_cast<Y>(b), static_cast<Y>(c[i]), static_cast<Y>(d)});
+            }
+            wide endSlope = secant[n - 2] + h[n - 2] * (c[n - 2] + 2 * c[n - 1]) / 3;
+            cubics.push_back({ys[n - 1], static_cast<Y>(endSlope), 0, 0});
+        }
+
+        //The curve's slope at each pair, after Fritsch and Carlson. Where the table turns, or is flat
+        //on either side, the slope is 0. Elsewhere it's a harmonic mean of the secants either side,
+        //weighted by the segment widths, which is at most three times either secant and so keeps each
+        //segment monotone. The ends use a three point estimate, held to the same limits.
+        static std::vector<wide> monotoneSlopes(std::vector<wide> const &h, std::vector<wide> const &secant) {
+            std::size_t n = h.size() + 1;
+            std::vector<wide> slopes(n);
+            if (n == 2) {
+                slopes[0] = slopes[1] = secant[0];
+                return slopes;
+            }
+            for (std::size_t i = 1; i + 1 < n; ++i) {
+                if (!(secant[i - 1] * secant[i] > 0)) continue;
+                wide before = 2 * h[i] + h[i - 1];
+                wide after = h[i] + 2 * h[i - 1];
+                slopes[i] = (before + after) / (before / secant[i - 1] + after / secant[i]);
+            }
+            slopes[0] = endSlope(h[0], h[1], secant[0], secant[1]);
+            slopes[n - 1] = endSlope(h[n - 2], h[n - 3], secant[n - 2], secant[n - 3]);
+            return slopes;
+        }
+
+        //slope at an end pair from its segment (width h, secant s) and the next one in
+        static wide endSlope(wide h, wide nextH, wide s, wide nextS) {
+            wide slope = ((2 * h + nextH) * s - h * nextS) / (h + nextH);
+            if (!(slope * s > 0)) return 0;
+            if (s * nextS < 0 && std::abs(slope) > std::abs(3 * s)) return 3 * s;
+            return slope;
+        }
+
+        //each segment's cubic from the slopes at its ends
+        void fitHermite(std::vector<wide> const &h, std::vector<wide> const &secant, std::vector<wide> const &slopes) {
+            std::span<const Y> ys = table.yValues();
+            std::size_t n = ys.size();
+            cubics.reserve(n + 1);
+            cubics.push_back({ys[0], static_cast<Y>(slopes[0]), 0, 0});
+            for (std::size_t i = 0; i + 1 < n; ++i) {
+                wide c = (3 * secant[i] - 2 * slopes[i] - slopes[i + 1]) / h[i];
+                wide d = (slopes[i] + slopes[i + 1] - 2 * secant[i]) / (h[i] * h[i]);
+                cubics.push_back({ys[i], static_cast<Y>(slopes[i]), static_cast<Y>(c), static_cast<Y>(d)});
+            }
+            cubics.push_back({ys[n - 1], static_cast<Y>(slopes[n - 1]), 0, 0});
+        }
+    };
+
+    //A table fixed at compile time: N pairs held in the object, no allocation, and every member
+    //usable in constant expressions. Results match interpolation<X, Y> with the default search.
+    //Checks run in the constructor, so a table built as constexpr can be checked where it's declared:
+    //
+    //    constexpr simpleTools::fixedInterpolation gain(std::array{std::pair{0.0, 1.0}, std::pair{10.0, 1.5}}, 0.01);
+    //    static_assert(gain.status() == simpleTools::InterpolationResultType::OK);
+    template<class X, class Y, std::size_t N>
+    class fixedInterpolation {
+        static_assert(N >= 2, "an interpolation table needs at least 2 pairs");
+
+    public:
+        constexpr fixedInterpolation(std::array<std::pair<X, Y>, N> const &table, std::type_identity_t<X> p) :
+            precision(p) {
+            for (std::size_t i = 0; i < N; ++i) {
+                xs[i] = table[i].first;
+                ys[i] = table[i].second;
+            }
+            tableStatus = InterpolationResultType::OK;
+            for (std::size_t i = 1; i < N; ++i) {
+                if (xs[i] < xs[i - 1]) tableStatus = InterpolationResultType::dataUnsorted;
+                if (xs[i] == xs[i - 1]) duplicates = true;
+            }
+        }
+
+        //OK, or dataUnsorted when the Xs aren't ascending
+        constexpr InterpolationResultType status() const { return tableStatus; }
+
+        constexpr bool hasDuplicates() const { return duplicates; }
+
+        constexpr std::tuple<InterpolationResultType, Y> nearestY(X x) const {
+            if (tableStatus != InterpolationResultType::OK) return {tableStatus, 0};
+
+            std::size_t rhs = upperBound(x);
+            if (rhs == 0) return {InterpolationResultType::lessThanData, ys[0]};
+            if (std::size_t hit = exactHit(x, rhs); hit != N) return {InterpolationResultType::OK, ys[hit]};
+            if (rhs == N) return {InterpolationResultType::greaterThanData, ys[N - 1]};
+
+            X leftDelta = static_cast<X>(magnitude(x - xs[rhs - 1]) / precision);
+            X rightDelta = static_cast<X>(magnitude(x - xs[rhs]) / precision);
+            if (int(leftDelta) < int(rightDelta)) return {InterpolationResultType::OK, ys[rhs - 1]};
+            return {InterpolationResultType::OK, ys[rhs]};
+        }
+
+        constexpr std::tuple<InterpolationResultType, Y> getY(X x) const {
+            if (tableStatus != InterpolationResultType::OK) return {tableStatus, 0};
+
+            std::size_t rhs = upperBound(x);
+            if (std::size_t hit = exactHit(x, rhs); hit != N) return {InterpolationResultType::OK, ys[hit]};
+
+            //off either end: y = mx + b through the nearest two pairs
+            if (rhs == 0 || rhs == N) {
+                std::size_t lhs = rhs == 0 ? 0 : N - 2;
+                std::tuple<InterpolationResultType, Y> result = computeSlope(lhs);
+                if (std::get<0>(result) == InterpolationResultType::divideByZero) return result;
+                Y m = std::get<1>(result);
+                Y b = ys[lhs] - simd::unfused(m * xs[lhs]);
+                return {InterpolationResultType::OK, simd::unfused(m * x) + b};
+            }
+
+            std::tuple<InterpolationResultType, Y> result = computeSlope(rhs - 1);
+            if (std::get<0>(result) == InterpolationResultType::divideByZero) return result;
+            return {InterpolationResultType::OK, ys[rhs - 1] + simd::unfused((x - xs[rhs - 1]) * std::get<1>(result))};
+        }
+
+    private:
+        std::array<X, N> xs{};
+        std::array<Y, N> ys{};
+        X precision;
+        InterpolationResultType tableStatus = InterpolationResultType::OK;
+        bool duplicates = false;
+
+        //Index of the first X greater than x. N is fixed, so the loop runs log2(N) times with no
+        //data dependent branch and unrolls completely.
+        constexpr std::size_t upperBound(X x) const {
+            std::size_t base = 0;
+            std::size_t length = N;
+            while (length > 1) {
+                std::size_t half = length / 2;
+                base = (x < xs[base + half]) ? base : base + half;
+                length -= half;
+            }
+            return base + static_cast<std::size_t>(!(x < xs[base]));
+        }
+
+        //the pair x hits exactly, by interpolation's rules, or N
+        constexpr std::size_t exactHit(X x, std::size_t rhs) const {
+            if (rhs == 0 || !(xs[rhs - 1] == x)) return N;
+            std::size_t lhs = rhs - 1;
+            while (duplicates && lhs != 0 && xs[lhs - 1] == x) --lhs;
+            return (lhs != N - 1 || N == 2) ? lhs : N;
+        }
+
+        //fabs() as interpolation<X, Y> calls it, through double
+        static constexpr double magnitude(double value) { return value < 0 ? -value : value; }
+
+        constexpr std::tuple<InterpolationResultType, Y> computeSlope(std::size_t lhs) const {
+            X denominator = xs[lhs + 1] - xs[lhs];
+            if (static_cast<X>(magnitude(static_cast<double>(denominator))) < static_cast<X>(0.0001)) {
+                return {InterpolationResultType::divideByZero, 0};
+            }
+            return {InterpolationResultType::OK, static_cast<Y>((ys[lhs + 1] - ys[lhs]) / denominator)};
+        }
     };
 }
+
+#endif
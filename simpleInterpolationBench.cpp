@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2017-2021 David C. Halonen
+ * The MIT License
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+ * Software, and to permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included
+ *   in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Throughput and latency of getY()/nearestY().
+ *
+ *   simpleBench [--sizes 2,1000,...] [--max-size N] [--queries N] [--types float,double,...]
+ *               [--distributions uniform,sorted,...] [--format csv|json]
+ *
+ * One line per (type, method, api, size, distribution) on stdout, with the memory the method's index
+ * uses. Queries are timed in chunks of 64; the percentiles are over the per-query time of each chunk.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "simpleInterpolation.h"
+
+namespace {
+    constexpr std::size_t chunkSize = 64;
+
+    struct options {
+        std::vector<std::size_t> sizes{2, 16, 128, 1024, 10000, 100000, 1000000, 10000000};
+        std::size_t maxSize = 10000000;
+        std::size_t queries = 1 << 16;
+        std::vector<std::string> types{"float", "double", "long double", "int"};
+        std::vector<std::string> distributions{"uniform", "sorted", "clustered", "outOfRange"};
+        std::string format = "csv";
+    };
+
+    struct searchMethod {
+        char const *name;
+        simpleTools::SearchMethod method;
+        std::size_t maxSize;    //beyond this the method is too slow to be worth timing
+    };
+
+    searchMethod const searchMethods[] = {
+            {"linearScan",   simpleTools::SearchMethod::linearScan,   10000},
+            {"binarySearch", simpleTools::SearchMethod::binarySearch, std::size_t(-1)},
+            {"eytzinger",    simpleTools::SearchMethod::eytzinger,    std::size_t(-1)},
+            {"bPlusTree",    simpleTools::SearchMethod::bPlusTree,    std::size_t(-1)},
+            {"learned",      simpleTools::SearchMethod::learned,      std::size_t(-1)},
+            {"interpolationSearch", simpleTools::SearchMethod::interpolationSearch, std::size_t(-1)},
+            {"bucketDirectory",     simpleTools::SearchMethod::bucketDirectory,     std::size_t(-1)},
+    };
+
+    struct measurement {
+        double nsPerQuery;
+        double queriesPerSecond;
+        double p50, p90, p99, p999;
+    };
+
+    std::vector<std::string> split(std::string const &list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) items.push_back(item);
+        return items;
+    }
+
+    bool wanted(std::vector<std::string> const &list, std::string const &item) {
+        return std::find(list.begin(), list.end(), item) != list.end();
+    }
+
+    double percentile(std::vector<double> &sorted, double fraction) {
+        std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1));
+        return sorted[index];
+    }
+
+    //Ascending X with uneven gaps, so no table is mistaken for a uniform grid.
+    template<class X, class Y>
+    std::shared_ptr<std::vector<std::pair<X, Y> > > makeTable(std::size_t size, std::mt19937 &gen) {
+        std::uniform_int_distribution<int> gap(1, 100);
+        std::uniform_real_distribution<double> value(-1000.0, 1000.0);
+        std::shared_ptr<std::vector<std::pair<X, Y> > > table(new std::vector<std::pair<X, Y> >);
+        table->reserve(size);
+        long long x = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            x += gap(gen);
+            table->push_back({static_cast<X>(x), static_cast<Y>(value(gen))});
+        }
+        if (size == 2) (*table)[1].first = static_cast<X>((*table)[0].first + 7);
+        return table;
+    }
+
+    template<class X>
+    std::vector<X> makeQueries(std::string const &distribution, std::size_t count, double first, double last,
+                               std::mt19937 &gen) {
+        std::vector<X> queries(count);
+        double span = last - first;
+        if (distribution == "clustered") {   //a handful of hot spots, each a tiny part of the table
+            std::uniform_real_distribution<double> centre(first, last);
+            std::vector<double> centres{centre(gen), centre(gen), centre(gen), centre(gen)};
+            std::normal_distribution<double> spread(0.0, span / 1000.0);
+            for (std::size_t i = 0; i < count; ++i) {
+                double q = std::clamp(centres[i % centres.size()] + spread(gen), first, last);
+                queries[i] = static_cast<X>(q);
+            }
+        } else if (distribution == "outOfRange") {  //half off either end
+            std::uniform_real_distribution<double> offset(1.0, span + 1.0);
+            for (std::size_t i = 0; i < count; ++i) {
+                queries[i] = static_cast<X>((i % 2 == 0) ? first - offset(gen) : last + offset(gen));
+            }
+        } else {
+            std::uniform_real_distribution<double> anywhere(first, last);
+            for (X &q : queries) q = static_cast<X>(anywhere(gen));
+            if (distribution == "sorted") std::sort(queries.begin(), queries.end());
+        }
+        return queries;
+    }
+
+    //Times run(begin, end) over successive chunks of the queries, after one untimed pass.
+    template<class X, class Run>
+    measurement measure(std::vector<X> const &queries, Run run) {
+        run(std::size_t(0), queries.size());
+
+        std::vector<double> perQuery;
+        perQuery.reserve(queries.size() / chunkSize + 1);
+        auto started = std::chrono::steady_clock::now();
+        for (std::size_t begin = 0; begin < queries.size(); begin += chunkSize) {
+            std::size_t end = std::min(begin + chunkSize, queries.size());
+            auto chunkStarted = std::chrono::steady_clock::now();
+            run(begin, end);
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - chunkStarted;
+            perQuery.push_back(elapsed.count() / static_cast<double>(end - begin));
+        }
+        std::chrono::duration<double, std::nano> total = std::chrono::steady_clock::now() - started;
+
+        std::sort(perQuery.begin(), perQuery.end());
+        double nsPerQuery = total.count() / static_cast<double>(queries.size());
+        return {nsPerQuery, 1e9 / nsPerQuery,
+                percentile(perQuery, 0.5), percentile(perQuery, 0.9),
+                percentile(perQuery, 0.99), percentile(perQuery, 0.999)};
+    }
+
+    void report(options const &opts, std::string const &type, std::string const &method, std::string const &api,
+                std::size_t size, std::string const &distribution, std::size_t queries, std::size_t indexBytes,
+                measurement const &m) {
+        if (opts.format == "json") {
+            std::cout << "{\"type\":\"" << type << "\",\"method\":\"" << method << "\",\"api\":\"" << api
+                      << "\",\"size\":" << size << ",\"distribution\":\"" << distribution
+                      << "\",\"queries\":" << queries << ",\"index_bytes\":" << indexBytes
+                      << ",\"ns_per_query\":" << m.nsPerQuery
+                      << ",\"queries_per_sec\":" << m.queriesPerSecond << ",\"p50_ns\":" << m.p50
+                      << ",\"p90_ns\":" << m.p90 << ",\"p99_ns\":" << m.p99 << ",\"p999_ns\":" << m.p999 << "}\n";
+        } else {
+            std::cout << type << ',' << method << ',' << api << ',' << size << ',' << distribution << ','
+                      << queries << ',' << indexBytes << ',' << m.nsPerQuery << ',' << m.queriesPerSecond << ',' << m.p50 << ','
+                      << m.p90 << ',' << m.p99 << ',' << m.p999 << '\n';
+        }
+        std::cout.flush();
+    }
+
+    template<class X, class Y>
+    void benchType(options const &opts, std::string const &type) {
+        std::mt19937 gen(2017);
+        for (std::size_t size : opts.sizes) {
+            if (size < 2 || size > opts.maxSize) continue;
+            auto table = makeTable<X, Y>(size, gen);
+            double first = static_cast<double>(table->front().first);
+            double last = static_cast<double>(table->back().first);
+
+            for (std::string const &distribution : opts.distributions) {
+                std::vector<X> queries = makeQueries<X>(distribution, opts.queries, first, last, gen);
+                std::vector<Y> ys(queries.size());
+                volatile double sink = 0;
+
+                for (searchMethod const &search : searchMethods) {
+                    if (size > search.maxSize) continue;
+                    simpleTools::interpolation<X, Y> intrp(table, static_cast<X>(1), search.method);
+
+                    measurement m = measure(queries, [&](std::size_t begin, std::size_t end) {
+                        double sum = 0;
+                        for (std::size_t i = begin; i < end; ++i) sum += static_cast<double>(std::get<1>(intrp.getY(queries[i])));
+                        sink = sink + sum;
+                    });
+                    report(opts, type, search.name, "getY", size, distribution, queries.size(), intrp.indexBytes(), m);
+
+                    m = measure(queries, [&](std::size_t begin, std::size_t end) {
+                        double sum = 0;
+                        for (std::size_t i = begin; i < end; ++i) sum += static_cast<double>(std::get<1>(intrp.nearestY(queries[i])));
+                        sink = sink + sum;
+                    });
+                    report(opts, type, search.name, "nearestY", size, distribution, queries.size(), intrp.indexBytes(), m);
+
+                    m = measure(queries, [&](std::size_t begin, std::size_t end) {
+                        std::span<const X> xs(queries.data() + begin, end - begin);
+                        intrp.getY(xs, std::span<Y>(ys.data() + begin, end - begin));
+                        sink = sink + static_cast<double>(ys[begin]);
+                    });
+                    report(opts, type, search.name, "batchGetY", size, distribution, queries.size(), intrp.indexBytes(), m);
+                }
+            }
+        }
+    }
+
+    bool parse(int argc, char **argv, options &opts) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+            if (arg == "--sizes") {
+                opts.sizes.clear();
+                for (std::string const &size : split(value)) opts.sizes.push_back(std::strtoull(size.c_str(), nullptr, 10));
+            } else if (arg == "--max-size") {
+                opts.maxSize = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (arg == "--queries") {
+                opts.queries = std::max<std::size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+            } else if (arg == "--types") {
+                opts.types = split(value);
+            } else if (arg == "--distributions") {
+                opts.distributions = split(value);
+            } else if (arg == "--format") {
+                opts.format = value;
+            } else {
+                return false;
+            }
+        }
+        return opts.format == "csv" || opts.format == "json";
+    }
+}
+
+int main(int argc, char **argv) {
+    options opts;
+    if (!parse(argc, argv, opts)) {
+        std::cerr << "usage: simpleBench [--sizes 2,1000,...] [--max-size N] [--queries N]\n"
+                     "                   [--types float,double,long double,int]\n"
+                     "                   [--distributions uniform,sorted,clustered,outOfRange] [--format csv|json]\n";
+        return 1;
+    }
+
+    if (opts.format == "csv") {
+        std::cout << "type,method,api,size,distribution,queries,index_bytes,ns_per_query,queries_per_sec,p50_ns,p90_ns,p99_ns,p999_ns\n";
+    }
+    if (wanted(opts.types, "float")) benchType<float, float>(opts, "float");
+    if (wanted(opts.types, "double")) benchType<double, double>(opts, "double");
+    if (wanted(opts.types, "long double")) benchType<long double, long double>(opts, "long double");
+    if (wanted(opts.types, "int")) benchType<int, double>(opts, "int");
+    return 0;
+}
@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2017-2021 David C. Halonen  
+ * The MIT License
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of 
+ * this software and associated documentation files (the "Software"), to deal in 
+ * the Software without restriction, including without limitation the rights to use, 
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the 
+ * Software, and to permit persons to whom the Software is furnished to do so, subject 
+ * to the following conditions: 
+ *
+ *   The above copyright notice and this permission notice shall be included 
+ *   in all copies or substantial portions of the Software.  
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A 
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION 
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE 
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef SIMPLE_INTERPOLATION_IO_H
+#define SIMPLE_INTERPOLATION_IO_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <span>
+#include <type_traits>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define SIMPLE_INTERPOLATION_MMAP 1
+#endif
+
+#include "simpleInterpolation.h"
+
+//A binary table file holds a table in the form the interpolation class searches it, so loading
+//one is a mapping of the file rather than a parse:
+//
+//   offset 0    tableFileHeader, 64 bytes
+//   offset 64   count X values
+//   next multiple of 64 after the X values: count Y values
+//   next multiple of 64 after the Y values: the table's search index, if it has one
+//
+//Numbers are stored in the writer's byte order, which the header records; a file from a machine
+//of the other byte order is refused rather than converted.
+namespace simpleTools {
+
+    enum class TableFileResult {
+        OK,
+        cannotOpen,
+        writeFailed,
+        badFormat,          //not a table file, or truncated
+        versionMismatch,
+        byteOrderMismatch,
+        typeMismatch,       //the file's X or Y type isn't the one asked for
+        tableNotOK,         //saveTable() was handed a table that didn't validate
+        parseError          //a line of a text table isn't a pair of numbers; see errorLine()
+    };
+
+    struct tableFileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint8_t xType;
+        std::uint8_t yType;
+        std::uint8_t status;            //InterpolationResultType from validate()
+        std::uint8_t flags;             //tableFileDuplicates | tableFileUniform
+        std::uint8_t searchMethod;      //the SearchMethod the table was saved with
+        std::uint8_t reserved[3];
+        std::uint64_t count;
+        unsigned char precision[8];     //an X, in its own representation
+        std::uint64_t indexOffset;      //interpolation::indexSnapshot(); 0 when there's none
+        std::uint64_t indexBytes;
+        std::uint64_t dataChecksum;     //interpolation::dataChecksum()
+    };
+    static_assert(sizeof(tableFileHeader) == 64);
+    static_assert(std::is_trivially_copyable_v<tableFileHeader>);
+
+    inline constexpr char tableFileMagic[8] = {'s', 'i', 'm', 'p', 'T', 'a', 'b', '\n'};
+    inline constexpr std::uint32_t tableFileVersion = 1;
+    inline constexpr std::uint32_t tableFileByteOrder = 0x01020304;
+    inline constexpr std::uint8_t tableFileDuplicates = 1;
+    inline constexpr std::uint8_t tableFileUniform = 2;
+
+    namespace tableFile {
+        //type tags for the header; 0 for types files can't hold
+        template<class T>
+        constexpr std::uint8_t typeTag() {
+            if constexpr (std::is_same_v<T, float>) return 1;
+            else if constexpr (std::is_same_v<T, double>) return 2;
+            else if constexpr (std::is_same_v<T, std::int32_t>) return 3;
+            else if constexpr (std::is_same_v<T, std::int64_t>) return 4;
+            else return 0;
+        }
+
+        constexpr std::uint64_t alignUp(std::uint64_t offset) { return (offset + 63) / 64 * 64; }
+
+        template<class X>
+        constexpr std::uint64_t yOffset(std::uint64_t count) { return alignUp(sizeof(tableFileHeader) + count * sizeof(X)); }
+    }
+
+    //Write a validated table to path, replacing any file there.
+    template<class X, class Y>
+    TableFileResult saveTable(std::string const &path, interpolation<X, Y> const &table) {
+        static_assert(tableFile::typeTag<X>() != 0 && tableFile::typeTag<Y>() != 0,
+                      "table files hold float, double, int32_t and int64_t columns");
+        if (table.status() != InterpolationResultType::OK) return TableFileResult::tableNotOK;
+
+        std::span<const X> xs = table.xValues();
+        std::span<const Y> ys = table.yValues();
+        tableFacts facts = table.facts();
+        X precision = table.getPrecision();
+
+        tableFileHeader header{};
+        std::memcpy(header.magic, tableFileMagic, sizeof(header.magic));
+        header.version = tableFileVersion;
+        header.byteOrder = tableFileByteOrder;
+        header.xType = tableFile::typeTag<X>();
+        header.yType = tableFile::typeTag<Y>();
+        header.status = static_cast<std::uint8_t>(facts.status);
+        header.flags = static_cast<std::uint8_t>((facts.duplicates ? tableFileDuplicates : 0) |
+                                                 (facts.uniform.value_or(false) ? tableFileUniform : 0));
+        header.searchMethod = static_cast<std::uint8_t>(table.searchMethod());
+        header.count = xs.size();
+        std::memcpy(header.precision, &precision, sizeof(X));
+        header.dataChecksum = table.dataChecksum();
+
+        cacheLineVector<unsigned char> index;
+        if (table.hasIndex()) index = table.indexSnapshot();
+        std::uint64_t yEnd = tableFile::yOffset<X>(xs.size()) + ys.size_bytes();
+        if (!index.empty()) {
+            header.indexOffset = tableFile::alignUp(yEnd);
+            header.indexBytes = index.size();
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return TableFileResult::cannotOpen;
+        char const padding[64] = {};
+        std::uint64_t xEnd = sizeof(header) + xs.size_bytes();
+        out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        out.write(reinterpret_cast<char const *>(xs.data()), static_cast<std::streamsize>(xs.size_bytes()));
+        out.write(padding, static_cast<std::streamsize>(tableFile::yOffset<X>(xs.size()) - xEnd));
+        out.write(reinterpret_cast<char const *>(ys.data()), static_cast<std::streamsize>(ys.size_bytes()));
+        if (!index.empty()) {
+            out.write(padding, static_cast<std::streamsize>(header.indexOffset - yEnd));
+            out.write(reinterpret_cast<char const *>(index.data()), static_cast<std::streamsize>(index.size()));
+        }
+        out.close();
+        return out ? TableFileResult::OK : TableFileResult::writeFailed;
+    }
+
+    //A table file mapped read only. Its pages are shared with every other process mapping the same
+    //file, and open() reads only the header, so it takes the same time whatever the table's size.
+    //Where mmap isn't available the file is read into memory instead.
+    //
+    //view() returns an interpolation over the mapped columns. It trusts the verdict recorded when
+    //the file was saved, so the mapping must outlive every view and the file must not be changed
+    //while mapped. A view is O(1) for the search methods without an index and for grids. The
+    //others checksum the whole table before using the saved index, or build one when that fails,
+    //so their view() reads every pair: O(n), about 40 ms for 10^7 doubles.
+    template<class X, class Y>
+    class mappedTable {
+    public:
+        mappedTable() = default;
+        mappedTable(mappedTable const &) = delete;
+        mappedTable &operator=(mappedTable const &) = delete;
+        mappedTable(mappedTable &&other) noexcept { take(other); }
+        mappedTable &operator=(mappedTable &&other) noexcept {
+            if (this != &other) {
+                close();
+                take(other);
+            }
+            return *this;
+        }
+        ~mappedTable() { close(); }
+
+        TableFileResult open(std::string const &path) {
+            close();
+            TableFileResult result = map(path);
+            if (result == TableFileResult::OK) result = check();
+            if (result != TableFileResult::OK) close();
+            return result;
+        }
+
+        void close() {
+#ifdef SIMPLE_INTERPOLATION_MMAP
+            if (base != nullptr) munmap(const_cast<unsigned char *>(base), length);
+#endif
+            copy = cacheLineVector<std::uint64_t>();
+            fields = tableFileHeader{};
+            base = nullptr;
+            length = 0;
+        }
+
+        bool isOpen() const { return base != nullptr; }
+
+        std::span<const X> xValues() const {
+            if (!isOpen()) return {};
+            return {reinterpret_cast<X const *>(base + sizeof(tableFileHeader)), header().count};
+        }
+
+        std::span<const Y> yValues() const {
+            if (!isOpen()) return {};
+            return {reinterpret_cast<Y const *>(base + tableFile::yOffset<X>(header().count)), header().count};
+        }
+
+        //a copy of the file's header; all zeros when nothing is open
+        tableFileHeader const &header() const { return fields; }
+
+        tableFacts facts() const {
+            return {static_cast<InterpolationResultType>(header().status),
+                    (header().flags & tableFileDuplicates) != 0,
+                    (header().flags & tableFileUniform) != 0};
+        }
+
+        X precision() const {
+            X p;
+            std::memcpy(&p, header().precision, sizeof(X));
+            return p;
+        }
+
+        SearchMethod searchMethod() const { return static_cast<SearchMethod>(header().searchMethod); }
+
+        //the saved search index, empty if the file has none
+        std::span<const unsigned char> indexSnapshot() const {
+            if (!isOpen()) return {};
+            return {base + header().indexOffset, header().indexBytes};
+        }
+
+        //true when the columns still match the checksum taken when the file was saved; reads the
+        //whole table
+        bool verify() const {
+            return isOpen() && checksum(yValues().data(), yValues().size_bytes(),
+                                        checksum(xValues().data(), xValues().size_bytes())) == header().dataChecksum;
+        }
+
+        //The table as saved. The columns are not copied, nor scanned unless the chosen SearchMethod
+        //needs a search index: the saved one is then used if its checksum matches, and a new one is
+        //built if not.
+        interpolation<X, Y> view() const { return view(isOpen() ? searchMethod() : SearchMethod::binarySearch); }
+
+        interpolation<X, Y> view(SearchMethod s) const {
+            if (!isOpen()) return interpolation<X, Y>(std::span<const X>(), std::span<const Y>(), X(), s);
+            return interpolation<X, Y>(xValues(), yValues(), precision(), s, facts(), indexSnapshot());
+        }
+
+    private:
+        unsigned char const *base = nullptr;
+        std::size_t length = 0;
+        tableFileHeader fields{};
+        cacheLineVector<std::uint64_t> copy;    //the file's contents when it isn't mapped
+
+        void take(mappedTable &other) {
+            base = other.base;
+            length = other.length;
+            fields = other.fields;
+            other.fields = tableFileHeader{};
+            copy = std::move(other.copy);
+            other.base = nullptr;
+            other.length = 0;
+        }
+
+        TableFileResult map(std::string const &path) {
+#ifdef SIMPLE_INTERPOLATION_MMAP
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return TableFileResult::cannotOpen;
+            struct stat info;
+            if (fstat(fd, &info) != 0) {
+                ::close(fd);
+                return TableFileResult::cannotOpen;
+            }
+            if (static_cast<std::size_t>(info.st_size) < sizeof(tableFileHeader)) {
+                ::close(fd);
+                return TableFileResult::badFormat;
+            }
+            length = static_cast<std::size_t>(info.st_size);
+            void *pages = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);  //the mapping keeps the file
+            if (pages == MAP_FAILED) {
+                length = 0;
+                return TableFileResult::cannotOpen;
+            }
+            base = static_cast<unsigned char const *>(pages);
+#else
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in) return TableFileResult::cannotOpen;
+            std::streamoff size = in.tellg();
+            if (size < static_cast<std::streamoff>(sizeof(tableFileHeader))) return TableFileResult::badFormat;
+            copy.resize((static_cast<std::size_t>(size) + 7) / 8);
+            in.seekg(0);
+            if (!in.read(reinterpret_cast<char *>(copy.data()), size)) return TableFileResult::cannotOpen;
+            base = reinterpret_cast<unsigned char const *>(copy.data());
+            length = static_cast<std::size_t>(size);
+#endif
+            std::memcpy(&fields, base, sizeof(fields));
+            return TableFileResult::OK;
+        }
+
+        //the header only; the columns are trusted
+        TableFileResult check() const {
+            tableFileHeader const &h = header();
+            if (std::memcmp(h.magic, tableFileMagic, sizeof(h.magic)) != 0) return TableFileResult::badFormat;
+            if (h.version != tableFileVersion) return TableFileResult::versionMismatch;
+            if (h.byteOrder != tableFileByteOrder) return TableFileResult::byteOrderMismatch;
+            if (h.xType != tableFile::typeTag<X>() || h.yType != tableFile::typeTag<Y>()) return TableFileResult::typeMismatch;
+            if (h.status > static_cast<std::uint8_t>(InterpolationResultType::divideByZero) ||
+                h.searchMethod > static_cast<std::uint8_t>(SearchMethod::bucketDirectory)) return TableFileResult::badFormat;
+            //count can't exceed the file, so the sizes below can't overflow
+            if (h.count > length / sizeof(X) || h.count > length / sizeof(Y)) return TableFileResult::badFormat;
+            if (tableFile::yOffset<X>(h.count) + h.count * sizeof(Y) > length) return TableFileResult::badFormat;
+            if (h.indexOffset > length || h.indexBytes > length - h.indexOffset) return TableFileResult::badFormat;
+            return TableFileResult::OK;
+        }
+    };
+
+    //A table read from text, one pair per line: X, then Y, separated by a comma, a semicolon or
+    //blanks. Blank lines and lines starting with # are skipped, and so is a first line that isn't
+    //numbers, such as a CSV header. The file is read a chunk at a time and the numbers are parsed
+    //with std::from_chars, and the checks validate() makes are done along the way, so view()
+    //doesn't go over the columns again.
+    template<class X, class Y>
+    class textTable {
+    public:
+        TableFileResult read(std::string const &path) {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in) return TableFileResult::cannotOpen;
+            std::streamoff size = in.tellg();
+            in.seekg(0);
+            return parse(in, size > 0 ? static_cast<std::uint64_t>(size) : 0);
+        }
+
+        TableFileResult read(std::istream &in) { return parse(in, 0); }
+
+        //line, counting from 1, of the last parseError; 0 after a clean read
+        std::size_t errorLine() const { return badLine; }
+
+        //verdict on the pairs read, as validate() would give it
+        InterpolationResultType status() const { return tableStatus; }
+        bool hasDuplicates() const { return duplicates; }
+
+        std::span<const X> xValues() const { return xs; }
+        std::span<const Y> yValues() const { return ys; }
+        tableFacts facts() const { return {tableStatus, duplicates, std::nullopt}; }
+
+        //an interpolation over the columns read, which must outlive it
+        interpolation<X, Y> view(X precision, SearchMethod s = SearchMethod::binarySearch) const {
+            return interpolation<X, Y>(xValues(), yValues(), precision, s, facts());
+        }
+
+    private:
+        cacheLineVector<X> xs;
+        cacheLineVector<Y> ys;
+        InterpolationResultType tableStatus = InterpolationResultType::dataIncomplete;
+        bool duplicates = false;
+        std::size_t badLine = 0;
+
+        static constexpr std::size_t chunkBytes = std::size_t(1) << 20;
+
+        enum class lineKind { pair, skipped, bad };
+
+        //expectedBytes, when known, sizes the columns from the first chunk
+        TableFileResult parse(std::istream &in, std::uint64_t expectedBytes) {
+            xs.clear();
+            ys.clear();
+            tableStatus = InterpolationResultType::OK;
+            duplicates = false;
+            badLine = 0;
+
+            std::vector<char> buffer(chunkBytes);
+            std::size_t kept = 0;       //the start of an unfinished line, moved to the front of buffer
+            std::size_t line = 0;
+            std::uint64_t consumed = 0;
+            bool headerAllowed = true;
+            for (;;) {
+                if (kept == buffer.size()) buffer.resize(buffer.size() * 2);   //a line longer than a chunk
+                in.read(buffer.data() + kept, static_cast<std::streamsize>(buffer.size() - kept));
+                if (in.bad()) return TableFileResult::cannotOpen;
+                std::size_t filled = kept + static_cast<std::size_t>(in.gcount());
+                bool last = !in;
+
+                char const *p = buffer.data();
+                char const *end = p + filled;
+                while (p != end) {
+                    char const *eol = static_cast<char const *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+                    if (eol == nullptr) {
+                        if (!last) break;
+                        eol = end;
+                    }
+                    ++line;
+                    lineKind kind = parseLine(p, eol);
+                    if (kind == lineKind::bad) {
+                        if (!headerAllowed) {
+                            badLine = line;
+                            return TableFileResult::parseError;
+                        }
+                    }
+                    if (kind != lineKind::skipped) headerAllowed = false;
+                    p = eol == end ? end : eol + 1;
+                }
+
+                consumed += static_cast<std::uint64_t>(p - buffer.data());
+                if (expectedBytes != 0 && consumed != 0) {
+                    xs.reserve(static_cast<std::size_t>(expectedBytes / consumed * xs.size() + xs.size()));
+                    ys.reserve(xs.capacity());
+                    expectedBytes = 0;
+                }
+                kept = static_cast<std::size_t>(end - p);
+                std::memmove(buffer.data(), p, kept);
+                if (last) break;
+            }
+
+            if (xs.size() < 2) tableStatus = InterpolationResultType::dataIncomplete;
+            return TableFileResult::OK;
+        }
+
+        lineKind parseLine(char const *p, char const *end) {
+            if (p != end && end[-1] == '\r') --end;
+            p = skipBlanks(p, end);
+            if (p == end || *p == '#') return lineKind::skipped;
+
+            X x;
+            Y y;
+            char const *next = number(p, end, x);
+            if (next == nullptr) return lineKind::bad;
+            p = skipBlanks(next, end);
+            if (p != end && (*p == ',' || *p == ';')) p = skipBlanks(p + 1, end);
+            else if (p == next) return lineKind::bad;  //no separator at all
+            p = number(p, end, y);
+            if (p == nullptr || skipBlanks(p, end) != end) return lineKind::bad;
+
+            if (!xs.empty() && tableStatus == InterpolationResultType::OK) {
+                if (x < xs.back()) tableStatus = InterpolationResultType::dataUnsorted;
+                else if (x == xs.back()) duplicates = true;
+            }
+            xs.push_back(x);
+            ys.push_back(y);
+            return lineKind::pair;
+        }
+
+        static char const *skipBlanks(char const *p, char const *end) {
+            while (p != end && (*p == ' ' || *p == '\t')) ++p;
+            return p;
+        }
+
+        //from_chars, also taking a leading + sign; nullptr if there's no number at p
+        template<class T>
+        static char const *number(char const *p, char const *end, T &value) {
+            if (end - p > 1 && *p == '+' && p[1] != '-') ++p;
+            std::from_chars_result result = std::from_chars(p, end, value);
+            return result.ec == std::errc() ? result.ptr : nullptr;
+        }
+    };
+}
+
+#endif
@@ -19,13 +19,77 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS   /* Catch's alternate signal stack does not build against newer glibc */
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 
 #include <vector>
+#include <random>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <numbers>
 
 /* Unit Test Framework: https://github.com/philsquared/Catch, release v1.8.2 */
 #include "catch.hpp"
 
 #include "simpleInterpolation.h"
+#include "simpleInterpolationIO.h"
+
+/* Counts every heap allocation, so tests can check a call makes none. Every form of new and delete
+   is replaced, the aligned ones cacheLineAllocator uses included, and all of them go through
+   malloc() and free(), so sanitizers see matching pairs. */
+static std::atomic<std::size_t> allocationCount(0);
+
+static void *countedAllocation(std::size_t size, std::size_t alignment) noexcept {
+    ++allocationCount;
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void *countedAllocationOrThrow(std::size_t size, std::size_t alignment) {
+    if (void *p = countedAllocation(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size) { return countedAllocationOrThrow(size, 0); }
+void *operator new[](std::size_t size) { return countedAllocationOrThrow(size, 0); }
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept { return countedAllocation(size, 0); }
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept { return countedAllocation(size, 0); }
+void *operator new(std::size_t size, std::align_val_t a) { return countedAllocationOrThrow(size, static_cast<std::size_t>(a)); }
+void *operator new[](std::size_t size, std::align_val_t a) { return countedAllocationOrThrow(size, static_cast<std::size_t>(a)); }
+void *operator new(std::size_t size, std::align_val_t a, std::nothrow_t const &) noexcept {
+    return countedAllocation(size, static_cast<std::size_t>(a));
+}
+void *operator new[](std::size_t size, std::align_val_t a, std::nothrow_t const &) noexcept {
+    return countedAllocation(size, static_cast<std::size_t>(a));
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"    /* malloc'd by operator new above */
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::nothrow_t const &) noexcept { std::free(p); }
+void operator delete[](void *p, std::nothrow_t const &) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t, std::nothrow_t const &) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t, std::nothrow_t const &) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
 
 TEST_CASE("First test") {
     std::shared_ptr<std::vector<std::pair<double, double> > > graphData
@@ -250,3 +314,1198 @@ TEST_CASE("Unsorted data test") {
     result = nearDataIntrp.nearestY(4);
     REQUIRE(std::get<0>(result) == simpleTools::InterpolationResultType::dataUnsorted);
 }
+
+//Checks a SearchMethod against binary search on random tables of each size. X climbs from -50 in
+//steps of 1 to 21, every fifth X repeats the one before, and jump(i, size), when given, is added
+//before pair i. Queries are every exact hit, the extremes of X and 600 random points, half of them
+//around pair size / 2. vary(table, check), when given, calls check() once per setting it tries on
+//the table under test.
+template<class X>
+static void checkAgainstBinarySearch(simpleTools::SearchMethod search, std::initializer_list<std::size_t> sizes,
+                                     std::function<int(std::size_t, std::size_t)> jump = {},
+                                     std::function<void(simpleTools::interpolation<X, double> &, std::function<void()>)> vary = {}) {
+    std::mt19937 gen(2017);
+    std::uniform_int_distribution<int> step(0, 20);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    for (std::size_t size : sizes) {
+        std::shared_ptr<std::vector<std::pair<X, double> > > data(new std::vector<std::pair<X, double> >);
+        int x = -50;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (i % 5 != 3) x += 1 + step(gen);   //leave some duplicate Xs in the table
+            if (jump) x += jump(i, size);
+            data->push_back({static_cast<X>(x), value(gen)});
+        }
+
+        std::vector<X> queries{std::numeric_limits<X>::lowest(), std::numeric_limits<X>::max()};
+        if constexpr (std::numeric_limits<X>::has_infinity) {
+            queries.push_back(std::numeric_limits<X>::infinity());
+            queries.push_back(-std::numeric_limits<X>::infinity());
+            queries.push_back(std::numeric_limits<X>::quiet_NaN());
+        }
+        for (auto const &item : *data) queries.push_back(item.first);   //every exact hit
+        std::uniform_real_distribution<double> anywhere(static_cast<double>(data->front().first) - 30.0,
+                                                        static_cast<double>(data->back().first) + 30.0);
+        std::uniform_real_distribution<double> middle(static_cast<double>((*data)[size / 2].first) - 30.0,
+                                                      static_cast<double>((*data)[size / 2].first) + 300.0);
+        for (int i = 0; i < 300; ++i) {
+            queries.push_back(static_cast<X>(anywhere(gen)));
+            queries.push_back(static_cast<X>(middle(gen)));
+        }
+
+        simpleTools::interpolation<X, double> bisect(data, 1, simpleTools::SearchMethod::binarySearch);
+        simpleTools::interpolation<X, double> tested(data, 1, search);
+        REQUIRE(bisect.indexBytes() == 0);
+        if (size > 3) REQUIRE(!tested.isUniform());    //or the grid would answer instead
+
+        auto check = [&]() {
+            for (X q : queries) {
+                auto expected = bisect.getY(q);
+                auto actual = tested.getY(q);
+                REQUIRE(std::get<0>(expected) == std::get<0>(actual));
+                //integer Xs skip the divide by zero check, so duplicate Xs give NaN
+                REQUIRE((std::get<1>(expected) == std::get<1>(actual) ||
+                         (std::isnan(std::get<1>(expected)) && std::isnan(std::get<1>(actual)))));
+                REQUIRE(bisect.nearestY(q) == tested.nearestY(q));
+            }
+        };
+        if (vary) vary(tested, check);
+        else check();
+    }
+}
+
+TEMPLATE_TEST_CASE("Binary search matches linear scan", "", float, double, long double, int) {
+    checkAgainstBinarySearch<TestType>(simpleTools::SearchMethod::linearScan, {2, 3, 4, 7, 64, 1000});
+}
+
+TEMPLATE_TEST_CASE("Eytzinger search matches binary search", "", float, double, long double, int) {
+    checkAgainstBinarySearch<TestType>(simpleTools::SearchMethod::eytzinger, {2, 3, 4, 7, 8, 15, 16, 17, 64, 1000, 4095});
+}
+
+TEST_CASE("Eytzinger search test") {
+    std::shared_ptr<std::vector<std::pair<int, double> > > ints(new std::vector<std::pair<int, double> >(
+            {{1, 1.0}, {3, 2.0}, {4, 5.0}, {9, 4.0}, {10, 0.0}}));
+    simpleTools::interpolation<int, double> tree(ints, 0, simpleTools::SearchMethod::eytzinger);
+    REQUIRE(tree.getY(6) == std::make_tuple(simpleTools::InterpolationResultType::OK, 4.6));
+    REQUIRE(tree.nearestY(0) == std::make_tuple(simpleTools::InterpolationResultType::lessThanData, 1.0));
+    REQUIRE(tree.nearestY(12) == std::make_tuple(simpleTools::InterpolationResultType::greaterThanData, 0.0));
+
+    ints->push_back({2, 1.0});
+    REQUIRE(tree.validate() == simpleTools::InterpolationResultType::dataUnsorted);
+}
+
+TEMPLATE_TEST_CASE("B+ tree search matches binary search", "", float, double, long double, int) {
+    checkAgainstBinarySearch<TestType>(simpleTools::SearchMethod::bPlusTree,
+                                       {2, 3, 4, 5, 16, 17, 32, 33, 289, 290, 1000, 1089, 1090, 5000});
+}
+
+TEMPLATE_TEST_CASE("Learned index matches binary search", "", float, double, long double, int) {
+    //the odd jump breaks the fit into several lines
+    checkAgainstBinarySearch<TestType>(simpleTools::SearchMethod::learned, {2, 3, 4, 17, 100, 1000, 5000},
+                                       [](std::size_t i, std::size_t) { return i % 97 == 50 ? 10000 : 0; },
+                                       [](simpleTools::interpolation<TestType, double> &learned, std::function<void()> check) {
+        for (std::size_t error : {0, 1, 4, 16}) {
+            REQUIRE(learned.setLearnedError(error) == simpleTools::InterpolationResultType::OK);
+            REQUIRE((learned.isUniform() || learned.learnedSegments() >= 1));
+            check();
+        }
+    });
+}
+
+TEST_CASE("Learned index test") {
+    //nearly even timestamps fit in a handful of lines
+    std::mt19937 gen(2017);
+    std::shared_ptr<std::vector<std::pair<double, double> > > times(new std::vector<std::pair<double, double> >);
+    std::uniform_real_distribution<double> jitter(-0.2, 0.2);
+    for (int i = 0; i < 100000; ++i) times->push_back({1000.0 * i + jitter(gen), 0.5 * i});
+    simpleTools::interpolation<double, double> learned(times, 0.001, simpleTools::SearchMethod::learned);
+    REQUIRE(!learned.isUniform());
+    REQUIRE(learned.learnedSegments() < 10);
+    REQUIRE(learned.getY(1000.0 * 500 + 500.0) == simpleTools::interpolation<double, double>(times, 0.001).getY(1000.0 * 500 + 500.0));
+}
+
+TEMPLATE_TEST_CASE("Interpolation search matches binary search", "", float, double, long double, int) {
+    checkAgainstBinarySearch<TestType>(simpleTools::SearchMethod::interpolationSearch, {2, 3, 4, 17, 100, 1000, 5000});
+    //one outlier throws every guess off
+    checkAgainstBinarySearch<TestType>(simpleTools::SearchMethod::interpolationSearch, {2, 3, 4, 17, 100, 1000, 5000},
+                                       [](std::size_t i, std::size_t size) { return i + 1 == size ? 1000000 : 0; });
+}
+
+TEMPLATE_TEST_CASE("Bucket directory matches binary search", "", float, double, long double, int) {
+    //the jump crowds the pairs into a few buckets at either end
+    checkAgainstBinarySearch<TestType>(simpleTools::SearchMethod::bucketDirectory, {2, 3, 4, 17, 100, 1000, 5000},
+                                       [](std::size_t i, std::size_t size) { return i == size / 2 ? 100000 : 0; },
+                                       [](simpleTools::interpolation<TestType, double> &buckets, std::function<void()> check) {
+        //no more than log2(pairs) + 2 bits are used
+        unsigned most = static_cast<unsigned>(std::bit_width(buckets.xValues().size() - 1)) + 2;
+        for (unsigned bits : {0u, 1u, 3u, 8u, 12u, 40u}) {
+            REQUIRE(buckets.setBucketBits(bits) == (bits <= most));
+            if (!buckets.isUniform()) {
+                if (bits != 0) REQUIRE(buckets.bucketCount() == std::size_t(1) << std::min(bits, most));
+                REQUIRE(buckets.indexBytes() >= (buckets.bucketCount() + 1) * sizeof(std::size_t));
+            }
+            check();
+        }
+    });
+}
+
+namespace {
+    constexpr simpleTools::fixedInterpolation gainCurve(std::array{std::pair{1.0, 1.0}, std::pair{2.5, 1.3},
+                                                                   std::pair{3.75, 0.5}, std::pair{4.1, 2.25},
+                                                                   std::pair{5.3, 1.9}}, 0.1);
+    static_assert(gainCurve.status() == simpleTools::InterpolationResultType::OK);
+    static_assert(gainCurve.getY(2.5) == std::make_tuple(simpleTools::InterpolationResultType::OK, 1.3));
+    static_assert(std::get<1>(gainCurve.getY(4.7)) > 1.9 && std::get<1>(gainCurve.getY(4.7)) < 2.25);
+    static_assert(std::get<0>(gainCurve.nearestY(0.0)) == simpleTools::InterpolationResultType::lessThanData);
+
+    constexpr simpleTools::fixedInterpolation unsortedCurve(std::array{std::pair{1, 1.0}, std::pair{5, 2.0},
+                                                                       std::pair{3, 0.5}}, 1);
+    static_assert(unsortedCurve.status() == simpleTools::InterpolationResultType::dataUnsorted);
+}
+
+TEST_CASE("Compile-time table test") {
+    std::mt19937 gen(2017);
+    std::uniform_int_distribution<int> step(0, 20);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    std::array<std::pair<double, double>, 33> table{};
+    std::array<std::pair<int, double>, 33> intTable{};
+    int x = -50;
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        if (i % 5 != 3) x += 1 + step(gen);   //leave some duplicate Xs in the table
+        table[i] = {x / 4.0, value(gen)};
+        intTable[i] = {x, value(gen)};
+    }
+
+    simpleTools::fixedInterpolation fixed(table, 0.01);
+    simpleTools::interpolation<double, double> dynamic(std::make_shared<std::vector<std::pair<double, double> > >(table.begin(), table.end()), 0.01);
+    simpleTools::fixedInterpolation fixedInt(intTable, 1);
+    simpleTools::interpolation<int, double> dynamicInt(std::make_shared<std::vector<std::pair<int, double> > >(intTable.begin(), intTable.end()), 1);
+    REQUIRE(fixed.hasDuplicates());
+
+    std::uniform_real_distribution<double> anywhere(table.front().first - 10.0, table.back().first + 10.0);
+    std::vector<double> queries;
+    for (auto const &item : table) queries.push_back(item.first);   //every exact hit
+    for (int i = 0; i < 1000; ++i) queries.push_back(anywhere(gen));
+    for (double q : queries) {
+        REQUIRE(fixed.getY(q) == dynamic.getY(q));
+        REQUIRE(fixed.nearestY(q) == dynamic.nearestY(q));
+        int qi = static_cast<int>(q * 4);
+        auto expected = dynamicInt.getY(qi);
+        auto actual = fixedInt.getY(qi);
+        REQUIRE(std::get<0>(expected) == std::get<0>(actual));
+        //integer Xs skip the divide by zero check, so duplicate Xs give NaN
+        REQUIRE((std::get<1>(expected) == std::get<1>(actual) ||
+                 (std::isnan(std::get<1>(expected)) && std::isnan(std::get<1>(actual)))));
+        REQUIRE(fixedInt.nearestY(qi) == dynamicInt.nearestY(qi));
+    }
+
+    std::array<std::pair<float, float>, 2> pair{{{1.0f, 2.0f}, {3.0f, 4.0f}}};
+    simpleTools::fixedInterpolation fixedPair(pair, 0.1f);
+    REQUIRE(fixedPair.getY(3.0f) == std::make_tuple(simpleTools::InterpolationResultType::OK, 4.0f));
+    REQUIRE(fixedPair.getY(5.0f) == std::make_tuple(simpleTools::InterpolationResultType::OK, 6.0f));
+    REQUIRE(unsortedCurve.getY(2) == std::make_tuple(simpleTools::InterpolationResultType::dataUnsorted, 0.0));
+}
+
+template<class Q>
+static void checkFixedPoint() {
+    using raw = typename Q::raw;
+    std::mt19937 gen(2018);
+    //gentle tables, then steep ones with rises near the whole Q16.16 range over runs of a few hundred
+    //raw units, and a precision of one unit so queries between the pairs aren't taken as exact hits.
+    //On those the double answer, worked out as m * x + b, is itself only good to about 1e-6: finer than
+    //a Q16.16 unit, so that's still checked to the last place, but not a Q32.32 one.
+    for (auto [shortest, longest, highest, slack, within] : {std::tuple{0.01, 10.0, 100.0, 0.0, 0.01},
+                                                            std::tuple{0.001, 0.01, 30000.0, 1e-5, Q::toDouble(1)}})
+    for (std::size_t size : {2, 3, 17, 1000}) {
+        std::uniform_real_distribution<double> step(shortest, longest);
+        std::uniform_real_distribution<double> value(-highest, highest);
+        std::shared_ptr<std::vector<std::pair<raw, raw> > > fixedData(new std::vector<std::pair<raw, raw> >);
+        std::shared_ptr<std::vector<std::pair<double, double> > > data(new std::vector<std::pair<double, double> >);
+        double x = -500.0;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (i % 7 != 3) x += step(gen);   //leave some duplicate Xs in the table
+            fixedData->push_back({Q::fromDouble(x), Q::fromDouble(value(gen))});
+            data->push_back({Q::toDouble(fixedData->back().first), Q::toDouble(fixedData->back().second)});
+        }
+
+        raw precision = Q::fromDouble(within);
+        simpleTools::fixedPointInterpolation<Q> fixed(fixedData, precision);
+        simpleTools::interpolation<double, double> floating(data, Q::toDouble(precision));
+
+        std::vector<raw> queries;
+        for (auto const &item : *fixedData) queries.push_back(item.first);   //every exact hit
+        std::uniform_real_distribution<double> anywhere(data->front().first - 2 * longest, data->back().first + 2 * longest);
+        for (int i = 0; i < 20000; ++i) queries.push_back(Q::fromDouble(anywhere(gen)));
+
+        for (raw q : queries) {
+            auto expected = floating.getY(Q::toDouble(q));
+            auto actual = fixed.getY(q);
+            REQUIRE(std::get<0>(expected) == std::get<0>(actual));
+            INFO(Q::toDouble(q) << " " << std::get<1>(expected) << " " << Q::toDouble(std::get<1>(actual)));
+            if (std::get<1>(expected) >= Q::toDouble(std::numeric_limits<raw>::max())) {
+                REQUIRE(std::get<1>(actual) == std::numeric_limits<raw>::max());
+            } else if (std::get<1>(expected) <= Q::toDouble(std::numeric_limits<raw>::min())) {
+                REQUIRE(std::get<1>(actual) == std::numeric_limits<raw>::min());
+            } else if (std::get<0>(actual) == simpleTools::InterpolationResultType::OK) {
+                //within one unit in the last place of the fixed point format
+                REQUIRE(std::abs(Q::toDouble(std::get<1>(actual)) - std::get<1>(expected)) <= std::max(Q::toDouble(1), slack));
+            }
+
+            auto expectedNearest = floating.nearestY(Q::toDouble(q));
+            auto actualNearest = fixed.nearestY(q);
+            REQUIRE(std::get<0>(expectedNearest) == std::get<0>(actualNearest));
+            REQUIRE(std::get<1>(expectedNearest) == Q::toDouble(std::get<1>(actualNearest)));
+        }
+    }
+
+    //an evenly spaced table is searched by comparing Xs, whatever the SearchMethod asked for
+    std::shared_ptr<std::vector<std::pair<raw, raw> > > even(new std::vector<std::pair<raw, raw> >);
+    for (int i = 0; i < 300; ++i) even->push_back({Q::fromDouble(0.25 * i), Q::fromDouble(0.5 * (i % 13) - 3.0)});
+    simpleTools::fixedPointInterpolation<Q> bisected(even, Q::fromDouble(0.01));
+    std::uniform_real_distribution<double> across(-1.0, 76.0);
+    for (simpleTools::SearchMethod method : {simpleTools::SearchMethod::linearScan, simpleTools::SearchMethod::eytzinger,
+                                             simpleTools::SearchMethod::bPlusTree, simpleTools::SearchMethod::learned,
+                                             simpleTools::SearchMethod::interpolationSearch, simpleTools::SearchMethod::bucketDirectory}) {
+        simpleTools::fixedPointInterpolation<Q> fixed(even, Q::fromDouble(0.01), method);
+        bool estimates = method == simpleTools::SearchMethod::learned || method == simpleTools::SearchMethod::interpolationSearch ||
+                         method == simpleTools::SearchMethod::bucketDirectory;
+        REQUIRE(fixed.searchMethod() == (estimates ? simpleTools::SearchMethod::binarySearch : method));
+        for (int i = 0; i < 500; ++i) {
+            raw q = Q::fromDouble(across(gen));
+            REQUIRE(fixed.getY(q) == bisected.getY(q));
+            REQUIRE(fixed.nearestY(q) == bisected.nearestY(q));
+        }
+    }
+
+    //far off the end of a steep table, results saturate
+    std::shared_ptr<std::vector<std::pair<raw, raw> > > steep(new std::vector<std::pair<raw, raw> >(
+            {{Q::fromDouble(0.0), Q::fromDouble(0.0)}, {Q::fromDouble(1.0 / 1024), Q::fromDouble(1000.0)}}));
+    simpleTools::fixedPointInterpolation<Q> saturating(steep, 1);
+    REQUIRE(saturating.getY(std::numeric_limits<raw>::max()) ==
+            std::make_tuple(simpleTools::InterpolationResultType::OK, std::numeric_limits<raw>::max()));
+    REQUIRE(saturating.getY(std::numeric_limits<raw>::min()) ==
+            std::make_tuple(simpleTools::InterpolationResultType::OK, std::numeric_limits<raw>::min()));
+    REQUIRE(saturating.getY(Q::fromDouble(1.0 / 2048)) == std::make_tuple(simpleTools::InterpolationResultType::OK, Q::fromDouble(500.0)));
+
+    steep->push_back({Q::fromDouble(-1.0), 0});
+    REQUIRE(saturating.validate() == simpleTools::InterpolationResultType::dataUnsorted);
+    REQUIRE(std::get<0>(saturating.getY(0)) == simpleTools::InterpolationResultType::dataUnsorted);
+}
+
+TEST_CASE("Fixed point test") {
+    checkFixedPoint<simpleTools::q16_16>();
+#if defined(__SIZEOF_INT128__)
+    checkFixedPoint<simpleTools::q32_32>();
+#endif
+}
+
+TEST_CASE("Table view test") {
+    std::mt19937 gen(2020);
+    std::uniform_real_distribution<double> step(0.0, 2.0);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::shared_ptr<std::vector<std::pair<double, double> > > data(new std::vector<std::pair<double, double> >);
+    double x = -5.0;
+    for (int i = 0; i < 500; ++i) {
+        if (i % 5 != 3) x += step(gen);   //leave some duplicate Xs in the table
+        xs.push_back(x);
+        ys.push_back(value(gen));
+        data->push_back({xs.back(), ys.back()});
+    }
+
+    for (simpleTools::SearchMethod method : {simpleTools::SearchMethod::linearScan, simpleTools::SearchMethod::binarySearch,
+                                             simpleTools::SearchMethod::bPlusTree, simpleTools::SearchMethod::learned}) {
+        simpleTools::interpolation<double, double> view(xs, ys, 0.01, method);
+        simpleTools::interpolation<double, double> shared(data, 0.01, method);
+        REQUIRE(view.xValues().data() == xs.data());   //nothing copied
+        REQUIRE(view.yValues().data() == ys.data());
+        REQUIRE(view.hasDuplicates());
+
+        std::uniform_real_distribution<double> anywhere(xs.front() - 3.0, xs.back() + 3.0);
+        for (int i = 0; i < 500; ++i) {
+            double q = anywhere(gen);
+            REQUIRE(view.getY(q) == shared.getY(q));
+            REQUIRE(view.nearestY(q) == shared.nearestY(q));
+        }
+    }
+
+    //copies of a view still view the caller's arrays; copies of a shared table hold their own columns
+    simpleTools::interpolation<double, double> view(xs, ys, 0.01);
+    simpleTools::interpolation<double, double> viewCopy(view);
+    REQUIRE(viewCopy.xValues().data() == xs.data());
+    simpleTools::interpolation<double, double> sharedCopy(data, 0.01);
+    {
+        simpleTools::interpolation<double, double> original(data, 0.01);
+        sharedCopy = original;
+        REQUIRE(sharedCopy.xValues().data() != original.xValues().data());
+    }
+    REQUIRE(sharedCopy.getY(xs[10]) == view.getY(xs[10]));
+
+    //the view sees changes to the caller's arrays after validate()
+    ys[10] = 1234.0;
+    REQUIRE(view.validate() == simpleTools::InterpolationResultType::OK);
+    REQUIRE(std::get<1>(view.getY(xs[10])) == 1234.0);
+    xs[10] = xs[11] + 1.0;
+    REQUIRE(view.validate() == simpleTools::InterpolationResultType::dataUnsorted);
+
+    float const gainX[] = {0.0f, 1.0f, 2.0f};
+    float const gainY[] = {1.0f, 3.0f};
+    simpleTools::interpolation<float, float> mismatched(gainX, gainY, 0.1f);
+    REQUIRE(std::get<0>(mismatched.getY(0.5f)) == simpleTools::InterpolationResultType::dataIncomplete);
+}
+
+TEST_CASE("Table file test") {
+    std::mt19937 gen(2121);
+    std::uniform_real_distribution<double> step(0.0, 2.0);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    std::vector<double> xs;
+    std::vector<float> ys;
+    double x = 3.0;
+    for (int i = 0; i < 1001; ++i) {   //an X column that doesn't end on a 64 byte boundary
+        if (i % 7 != 2) x += step(gen);
+        xs.push_back(x);
+        ys.push_back(static_cast<float>(value(gen)));
+    }
+    std::string const path = "simpleTableFileTest.bin";
+    simpleTools::interpolation<double, float> table(xs, ys, 0.01, simpleTools::SearchMethod::bPlusTree);
+    REQUIRE(simpleTools::saveTable(path, table) == simpleTools::TableFileResult::OK);
+
+    {
+        simpleTools::mappedTable<double, float> mapped;
+        REQUIRE(mapped.open(path) == simpleTools::TableFileResult::OK);
+        REQUIRE(mapped.searchMethod() == simpleTools::SearchMethod::bPlusTree);
+        REQUIRE(mapped.precision() == 0.01);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(mapped.yValues().data()) % 64 == 0);
+
+        simpleTools::mappedTable<double, float> moved(std::move(mapped));
+        REQUIRE(!mapped.isOpen());
+        for (simpleTools::SearchMethod method : {simpleTools::SearchMethod::linearScan, simpleTools::SearchMethod::binarySearch,
+                                                 simpleTools::SearchMethod::eytzinger, simpleTools::SearchMethod::bucketDirectory}) {
+            simpleTools::interpolation<double, float> view = moved.view(method);
+            simpleTools::interpolation<double, float> original(xs, ys, 0.01, method);
+            REQUIRE(view.status() == simpleTools::InterpolationResultType::OK);
+            REQUIRE(view.hasDuplicates());
+            REQUIRE(view.xValues().data() == moved.xValues().data());   //the view reads the mapped file
+            std::uniform_real_distribution<double> anywhere(xs.front() - 3.0, xs.back() + 3.0);
+            for (int i = 0; i < 500; ++i) {
+                double q = anywhere(gen);
+                REQUIRE(view.getY(q) == original.getY(q));
+                REQUIRE(view.nearestY(q) == original.nearestY(q));
+            }
+        }
+    }
+
+    //an evenly spaced table is still known to be one after loading
+    std::vector<int> gridX = {0, 10, 20, 30, 40};
+    std::vector<int> gridY = {5, 4, 3, 2, 1};
+    REQUIRE(simpleTools::saveTable(path, simpleTools::interpolation<int, int>(gridX, gridY, 1)) == simpleTools::TableFileResult::OK);
+    simpleTools::mappedTable<int, int> grid;
+    REQUIRE(grid.open(path) == simpleTools::TableFileResult::OK);
+    REQUIRE(grid.view().isUniform());
+    REQUIRE(grid.view().getY(25) == std::make_tuple(simpleTools::InterpolationResultType::OK, 3));
+    REQUIRE(grid.open(path + ".missing") == simpleTools::TableFileResult::cannotOpen);
+    REQUIRE(!grid.isOpen());
+    REQUIRE(grid.view().status() == simpleTools::InterpolationResultType::dataIncomplete);
+
+    simpleTools::mappedTable<int, double> wrongType;
+    REQUIRE(wrongType.open(path) == simpleTools::TableFileResult::typeMismatch);
+
+    std::vector<int> unsortedX = {0, 2, 1};
+    REQUIRE(simpleTools::saveTable(path, simpleTools::interpolation<int, int>(unsortedX, std::vector<int>{1, 2, 3}, 1)) ==
+            simpleTools::TableFileResult::tableNotOK);
+
+    //truncated and corrupted files are refused from the header alone
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 4));
+        REQUIRE(grid.open(path) == simpleTools::TableFileResult::badFormat);
+        bytes[0] = 'x';
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        REQUIRE(grid.open(path) == simpleTools::TableFileResult::badFormat);
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), 10);
+        REQUIRE(grid.open(path) == simpleTools::TableFileResult::badFormat);
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Text table test") {
+    std::istringstream csv("# calibration export\r\n"
+                           "x,y\r\n"
+                           "1.0,10\r\n"
+                           "  2.5 ; -3e1\r\n"
+                           "\r\n"
+                           "2.5\t+7.25\r\n"
+                           "4, 8");
+    simpleTools::textTable<double, double> text;
+    REQUIRE(text.read(csv) == simpleTools::TableFileResult::OK);
+    REQUIRE(text.status() == simpleTools::InterpolationResultType::OK);
+    REQUIRE(text.hasDuplicates());
+    REQUIRE(std::vector<double>(text.xValues().begin(), text.xValues().end()) == std::vector<double>{1.0, 2.5, 2.5, 4.0});
+    REQUIRE(std::vector<double>(text.yValues().begin(), text.yValues().end()) == std::vector<double>{10.0, -30.0, 7.25, 8.0});
+    simpleTools::interpolation<double, double> view = text.view(0.01);
+    REQUIRE(view.xValues().data() == text.xValues().data());
+    REQUIRE(view.getY(1.75) == std::make_tuple(simpleTools::InterpolationResultType::OK, -10.0));
+
+    //more lines than one read, checked against the same pairs built in memory
+    std::mt19937 gen(2222);
+    std::uniform_int_distribution<int> step(0, 3);
+    std::uniform_int_distribution<int> value(-1000000, 1000000);
+    std::string lines;
+    std::vector<int> xs;
+    std::vector<int> ys;
+    int x = -500000;
+    for (int i = 0; i < 200000; ++i) {
+        x += step(gen);
+        xs.push_back(x);
+        ys.push_back(value(gen));
+        lines += std::to_string(xs.back()) + " " + std::to_string(ys.back()) + "\n";
+    }
+    std::istringstream big(lines);
+    simpleTools::textTable<int, int> ints;
+    REQUIRE(ints.read(big) == simpleTools::TableFileResult::OK);
+    REQUIRE(std::vector<int>(ints.xValues().begin(), ints.xValues().end()) == xs);
+    REQUIRE(std::vector<int>(ints.yValues().begin(), ints.yValues().end()) == ys);
+    simpleTools::interpolation<int, int> inMemory(xs, ys, 1);
+    REQUIRE(ints.facts().status == inMemory.facts().status);
+    REQUIRE(ints.hasDuplicates() == inMemory.hasDuplicates());
+    REQUIRE(ints.view(1).nearestY(12345) == inMemory.nearestY(12345));
+
+    std::string const path = "simpleTextTableTest.csv";
+    std::ofstream(path) << lines;
+    REQUIRE(ints.read(path) == simpleTools::TableFileResult::OK);
+    REQUIRE(ints.xValues().size() == xs.size());
+    std::remove(path.c_str());
+    REQUIRE(ints.read(path) == simpleTools::TableFileResult::cannotOpen);
+
+    std::istringstream unsorted("1 1\n3 3\n2 2\n");
+    REQUIRE(ints.read(unsorted) == simpleTools::TableFileResult::OK);
+    REQUIRE(ints.view(1).status() == simpleTools::InterpolationResultType::dataUnsorted);
+    std::istringstream single("1 1\n");
+    REQUIRE(ints.read(single) == simpleTools::TableFileResult::OK);
+    REQUIRE(ints.status() == simpleTools::InterpolationResultType::dataIncomplete);
+
+    for (char const *bad : {"1 1\n2 2\n3 x\n", "1 1\n2 2\n3\n", "1 1\n2 2\n3 3 3\n", "1 1\n2 2\n3 99999999999\n", "1 1\n2 2\n3,,3\n"}) {
+        std::istringstream in(bad);
+        REQUIRE(ints.read(in) == simpleTools::TableFileResult::parseError);
+        REQUIRE(ints.errorLine() == 3);
+    }
+}
+
+TEST_CASE("Index snapshot test") {
+    std::mt19937 gen(2323);
+    std::uniform_real_distribution<double> step(0.0, 2.0);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+    std::vector<double> xs;
+    std::vector<double> ys;
+    double x = 0.0;
+    for (int i = 0; i < 5000; ++i) {
+        x += step(gen) * step(gen);
+        xs.push_back(x);
+        ys.push_back(value(gen));
+    }
+    std::uniform_real_distribution<double> anywhere(xs.front() - 3.0, xs.back() + 3.0);
+
+    for (simpleTools::SearchMethod method : {simpleTools::SearchMethod::eytzinger, simpleTools::SearchMethod::bPlusTree,
+                                             simpleTools::SearchMethod::learned, simpleTools::SearchMethod::bucketDirectory}) {
+        simpleTools::interpolation<double, double> built(xs, ys, 0.01, method);
+        simpleTools::cacheLineVector<unsigned char> snapshot = built.indexSnapshot();
+        simpleTools::interpolation<double, double> restored(xs, ys, 0.01, method, built.facts(), snapshot);
+        REQUIRE(restored.indexAdopted());
+        REQUIRE(restored.indexBytes() < built.indexBytes());   //used in place
+        for (int i = 0; i < 500; ++i) {
+            double q = anywhere(gen);
+            REQUIRE(restored.getY(q) == built.getY(q));
+            REQUIRE(restored.bracket(q) == built.bracket(q));
+        }
+
+        //anything that doesn't match the snapshot has the index built again
+        simpleTools::interpolation<double, double> otherMethod(xs, ys, 0.01, simpleTools::SearchMethod::eytzinger == method ?
+                                                               simpleTools::SearchMethod::bPlusTree : simpleTools::SearchMethod::eytzinger,
+                                                               built.facts(), snapshot);
+        REQUIRE(!otherMethod.indexAdopted());
+        simpleTools::cacheLineVector<unsigned char> damaged = snapshot;
+        damaged.back() ^= 1;
+        REQUIRE(!simpleTools::interpolation<double, double>(xs, ys, 0.01, method, built.facts(), damaged).indexAdopted());
+        REQUIRE(!simpleTools::interpolation<double, double>(xs, ys, 0.01, method, built.facts(),
+                                                            std::span<const unsigned char>(snapshot).first(20)).indexAdopted());
+        std::vector<double> changed = ys;
+        changed[100] += 1.0;
+        simpleTools::interpolation<double, double> stale(xs, changed, 0.01, method, built.facts(), snapshot);
+        REQUIRE(!stale.indexAdopted());
+        REQUIRE(stale.indexBytes() != 0);
+        REQUIRE(std::get<1>(stale.getY(xs[100])) == changed[100]);
+    }
+
+    //the snapshot's setting is used, even when the index has to be built again
+    simpleTools::interpolation<double, double> fine(xs, ys, 0.01, simpleTools::SearchMethod::learned);
+    fine.setLearnedError(2);
+    simpleTools::cacheLineVector<unsigned char> fineSnapshot = fine.indexSnapshot();
+    simpleTools::interpolation<double, double> tuned(xs, ys, 0.01, simpleTools::SearchMethod::learned, fine.facts(), fineSnapshot);
+    REQUIRE(tuned.indexAdopted());
+    REQUIRE(tuned.learnedSegments() == fine.learnedSegments());
+    fineSnapshot[6] ^= 1;   //sizeof(std::size_t), as if saved by a build where it differs
+    simpleTools::interpolation<double, double> retuned(xs, ys, 0.01, simpleTools::SearchMethod::learned, fine.facts(), fineSnapshot);
+    REQUIRE(!retuned.indexAdopted());
+    REQUIRE(retuned.learnedSegments() == fine.learnedSegments());
+    REQUIRE(retuned.learnedSegments() > simpleTools::interpolation<double, double>(xs, ys, 0.01, simpleTools::SearchMethod::learned).learnedSegments());
+
+    simpleTools::interpolation<double, double> coarse(xs, ys, 0.01, simpleTools::SearchMethod::bucketDirectory);
+    coarse.setBucketBits(4);
+    simpleTools::cacheLineVector<unsigned char> coarseSnapshot = coarse.indexSnapshot();
+    simpleTools::interpolation<double, double> sixteen(xs, ys, 0.01, simpleTools::SearchMethod::bucketDirectory, coarse.facts(), coarseSnapshot);
+    REQUIRE(sixteen.indexAdopted());
+    REQUIRE(sixteen.bucketCount() == 16);
+
+    //Arrays that pass the checksum but don't fit the table, as a snapshot written for another
+    //table would, are not used. forge() puts value at byte at and seals the snapshot again; the
+    //index checksum is at byte 32 of the 48 byte header and covers the rest.
+    auto forge = [](simpleTools::cacheLineVector<unsigned char> snapshot, std::size_t at, std::size_t value) {
+        std::memcpy(snapshot.data() + at, &value, sizeof(value));
+        std::uint64_t sum = simpleTools::checksum(snapshot.data() + 48, snapshot.size() - 48);
+        std::memcpy(snapshot.data() + 32, &sum, sizeof(sum));
+        return snapshot;
+    };
+    simpleTools::cacheLineVector<unsigned char> forged = forge(coarseSnapshot, coarseSnapshot.size() - sizeof(std::size_t), xs.size() + 1000);
+    simpleTools::interpolation<double, double> pastEnd(xs, ys, 0.01, simpleTools::SearchMethod::bucketDirectory, coarse.facts(), forged);
+    REQUIRE(!pastEnd.indexAdopted());
+    REQUIRE(pastEnd.bucketCount() == 16);
+    REQUIRE(pastEnd.getY(xs.back()) == coarse.getY(xs.back()));
+
+    simpleTools::interpolation<double, double> eytzinger(xs, ys, 0.01, simpleTools::SearchMethod::eytzinger);
+    simpleTools::cacheLineVector<unsigned char> ranked = eytzinger.indexSnapshot();
+    std::size_t rankAt = (128 + (xs.size() + 1) * sizeof(double) + 63) / 64 * 64 + 64;     //after the keys and its count
+    REQUIRE(!simpleTools::interpolation<double, double>(xs, ys, 0.01, simpleTools::SearchMethod::eytzinger, eytzinger.facts(),
+                                                        forge(ranked, rankAt + 8 * sizeof(std::size_t), xs.size())).indexAdopted());
+
+    //table files carry the index, and a view of the mapped file adopts it
+    std::string const path = "simpleIndexSnapshotTest.bin";
+    simpleTools::interpolation<double, double> tree(xs, ys, 0.01, simpleTools::SearchMethod::bPlusTree);
+    REQUIRE(simpleTools::saveTable(path, tree) == simpleTools::TableFileResult::OK);
+    simpleTools::mappedTable<double, double> mapped;
+    REQUIRE(mapped.open(path) == simpleTools::TableFileResult::OK);
+    REQUIRE(mapped.verify());
+    REQUIRE(!mapped.indexSnapshot().empty());
+    simpleTools::interpolation<double, double> view = mapped.view();
+    REQUIRE(view.indexAdopted());
+    REQUIRE(view.xValues().data() == mapped.xValues().data());
+    for (int i = 0; i < 500; ++i) {
+        double q = anywhere(gen);
+        REQUIRE(view.getY(q) == tree.getY(q));
+    }
+    REQUIRE(!mapped.view(simpleTools::SearchMethod::bucketDirectory).indexAdopted());
+
+    //saving a view of a mapped table keeps the index it adopted
+    std::string const again = "simpleIndexSnapshotTest2.bin";
+    REQUIRE(simpleTools::saveTable(again, view) == simpleTools::TableFileResult::OK);
+    simpleTools::mappedTable<double, double> remapped;
+    REQUIRE(remapped.open(again) == simpleTools::TableFileResult::OK);
+    REQUIRE(!remapped.indexSnapshot().empty());
+    REQUIRE(remapped.view().indexAdopted());
+    std::remove(again.c_str());
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Spline test") {
+    //a clamped spline through a cubic, given the cubic's end slopes, is the cubic
+    auto cubic = [](double x) { return ((0.5 * x - 2.0) * x + 1.0) * x + 3.0; };
+    auto cubicSlope = [](double x) { return (1.5 * x - 4.0) * x + 1.0; };
+    std::shared_ptr<std::vector<std::pair<double, double> > > points(new std::vector<std::pair<double, double> >);
+    for (double x : {-3.0, -2.5, -1.0, 0.0, 0.2, 1.7, 2.0, 4.5, 5.0}) points->push_back({x, cubic(x)});
+    simpleTools::splineInterpolation<double, double> clamped(points, 0.001, cubicSlope(-3.0), cubicSlope(5.0));
+    REQUIRE(clamped.status() == simpleTools::InterpolationResultType::OK);
+    for (double x = -3.0; x <= 5.0; x += 0.01) {
+        REQUIRE(std::get<1>(clamped.getY(x)) == Approx(cubic(x)).margin(1e-9));
+    }
+    for (std::pair<double, double> const &point : *points) {
+        REQUIRE(clamped.getY(point.first) == std::make_tuple(simpleTools::InterpolationResultType::OK, point.second));
+    }
+    //off the ends: a straight line at the end slope
+    REQUIRE(std::get<1>(clamped.getY(6.0)) == Approx(cubic(5.0) + cubicSlope(5.0)).margin(1e-9));
+    REQUIRE(std::get<1>(clamped.getY(-4.0)) == Approx(cubic(-3.0) - cubicSlope(-3.0)).margin(1e-9));
+
+    //sin has no curvature at 0 and pi, as a natural spline assumes; 12 pairs beat linear
+    //interpolation over 120
+    auto table = [](int pairs) {
+        std::vector<double> xs;
+        std::vector<double> ys;
+        for (int i = 0; i < pairs; ++i) {
+            xs.push_back(std::numbers::pi * i / (pairs - 1));
+            ys.push_back(std::sin(xs.back()));
+        }
+        return std::make_pair(xs, ys);
+    };
+    auto [sparseX, sparseY] = table(12);
+    auto [denseX, denseY] = table(120);
+    simpleTools::splineInterpolation<double, double> natural(sparseX, sparseY, 1e-9);
+    simpleTools::interpolation<double, double> linear(denseX, denseY, 1e-9);
+    double splineError = 0.0;
+    double linearError = 0.0;
+    for (double x = 0.0; x <= std::numbers::pi; x += 0.001) {
+        splineError = std::max(splineError, std::abs(std::get<1>(natural.getY(x)) - std::sin(x)));
+        linearError = std::max(linearError, std::abs(std::get<1>(linear.getY(x)) - std::sin(x)));
+    }
+    REQUIRE(splineError < linearError);
+    REQUIRE(splineError < 1e-4);
+
+    //with two pairs a natural spline is a line; other tables and searches give the same curve
+    std::vector<int> lineX = {0, 10};
+    std::vector<double> lineY = {1.0, 6.0};
+    simpleTools::splineInterpolation<int, double> line(lineX, lineY, 1);
+    REQUIRE(std::get<1>(line.getY(4)) == Approx(3.0));
+    REQUIRE(std::get<1>(line.getY(-2)) == Approx(0.0).margin(1e-12));
+    std::shared_ptr<std::vector<std::pair<double, double> > > sparse(new std::vector<std::pair<double, double> >);
+    for (std::size_t i = 0; i < sparseX.size(); ++i) sparse->push_back({sparseX[i], sparseY[i]});
+    simpleTools::splineInterpolation<double, double> shared(sparse, 1e-9, simpleTools::SplineType::natural,
+                                                            simpleTools::SearchMethod::eytzinger);
+    for (double x = -1.0; x <= 4.0; x += 0.01) REQUIRE(shared.getY(x) == natural.getY(x));
+
+    //no spline through repeated or unsorted X, but nearestY() still works
+    sparse->push_back({sparseX.back(), 0.5});
+    REQUIRE(shared.validate() == simpleTools::InterpolationResultType::divideByZero);
+    REQUIRE(std::get<0>(shared.getY(1.0)) == simpleTools::InterpolationResultType::divideByZero);
+    REQUIRE(std::get<0>(shared.nearestY(1.0)) == simpleTools::InterpolationResultType::OK);
+    std::swap((*sparse)[2], (*sparse)[3]);
+    REQUIRE(shared.validate() == simpleTools::InterpolationResultType::dataUnsorted);
+    std::vector<double> one = {1.0};
+    simpleTools::splineInterpolation<double, double> single(one, one, 0.1, simpleTools::SplineType::clamped);
+    REQUIRE(std::get<0>(single.getY(1.0)) == simpleTools::InterpolationResultType::dataIncomplete);
+
+    //a clamped spline needs its end slopes
+    simpleTools::splineInterpolation<double, double> unclamped(points, 0.001, simpleTools::SplineType::clamped);
+    REQUIRE(unclamped.status() == simpleTools::InterpolationResultType::dataIncomplete);
+    REQUIRE(unclamped.getY(1.0) == std::make_tuple(simpleTools::InterpolationResultType::dataIncomplete, 0.0));
+    REQUIRE(std::get<0>(unclamped.nearestY(1.7)) == simpleTools::InterpolationResultType::OK);
+}
+
+TEST_CASE("Monotone spline test") {
+    //a transfer curve with flat stretches and steps: the curve must never turn back or overshoot
+    std::mt19937 gen(2525);
+    std::uniform_real_distribution<double> step(0.1, 3.0);
+    std::uniform_real_distribution<double> rise(0.0, 5.0);
+    std::vector<double> xs;
+    std::vector<double> ys;
+    double x = 0.0;
+    double y = 0.0;
+    for (int i = 0; i < 200; ++i) {
+        x += step(gen);
+        if (i % 6 != 0) y += i % 11 == 0 ? 40.0 : rise(gen);   //some flat stretches, some steps
+        xs.push_back(x);
+        ys.push_back(y);
+    }
+    simpleTools::splineInterpolation<double, double> curve(xs, ys, 1e-9, simpleTools::SplineType::monotone);
+    REQUIRE(curve.status() == simpleTools::InterpolationResultType::OK);
+
+    std::vector<double> queries;
+    for (double q = xs.front() - 5.0; q < xs.back() + 5.0; q += 0.003) queries.push_back(q);
+    std::vector<double> values(queries.size());
+    std::vector<simpleTools::InterpolationResultType> results(queries.size());
+    REQUIRE(curve.getY(queries, values, results) == simpleTools::InterpolationResultType::OK);
+    double const slack = 1e-9 * ys.back();
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        REQUIRE(results[i] == simpleTools::InterpolationResultType::OK);
+        if (i != 0) REQUIRE(values[i] >= values[i - 1] - slack);
+        std::size_t rhs = static_cast<std::size_t>(std::upper_bound(xs.begin(), xs.end(), queries[i]) - xs.begin());
+        if (rhs != 0 && rhs != xs.size()) {
+            REQUIRE(values[i] >= ys[rhs - 1] - slack);
+            REQUIRE(values[i] <= ys[rhs] + slack);
+        }
+    }
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        REQUIRE(curve.getY(xs[i]) == std::make_tuple(simpleTools::InterpolationResultType::OK, ys[i]));
+    }
+
+    //the batch matches getY() whatever the order, type of curve and search
+    std::shuffle(queries.begin(), queries.end(), gen);
+    queries.resize(5000);
+    for (simpleTools::SplineType type : {simpleTools::SplineType::natural, simpleTools::SplineType::monotone}) {
+        for (simpleTools::SearchMethod method : {simpleTools::SearchMethod::binarySearch, simpleTools::SearchMethod::bPlusTree}) {
+            simpleTools::splineInterpolation<double, double> spline(xs, ys, 1e-9, type, method);
+            for (simpleTools::QueryOrder order : {simpleTools::QueryOrder::unordered, simpleTools::QueryOrder::ascending}) {
+                if (order == simpleTools::QueryOrder::ascending) std::sort(queries.begin(), queries.end());
+                std::vector<double> batch(queries.size());
+                REQUIRE(spline.getY(queries, batch, {}, order) == simpleTools::InterpolationResultType::OK);
+                for (std::size_t i = 0; i < queries.size(); ++i) REQUIRE(batch[i] == std::get<1>(spline.getY(queries[i])));
+            }
+        }
+    }
+
+    //a falling table gives a falling curve; a line stays a line
+    std::vector<double> down = {9.0, 7.0, 7.0, 1.0, 0.5};
+    std::vector<double> downX = {0.0, 1.0, 3.0, 3.5, 8.0};
+    simpleTools::splineInterpolation<double, double> falling(downX, down, 1e-9, simpleTools::SplineType::monotone);
+    double last = std::get<1>(falling.getY(-1.0));
+    for (double q = -1.0; q < 9.0; q += 0.01) {
+        double value = std::get<1>(falling.getY(q));
+        REQUIRE(value <= last);
+        last = value;
+    }
+    REQUIRE(std::get<1>(falling.getY(2.0)) == 7.0);
+    std::vector<double> lineX = {0.0, 1.0, 4.0};
+    std::vector<double> lineY = {1.0, 3.0, 9.0};
+    simpleTools::splineInterpolation<double, double> line(lineX, lineY, 1e-9, simpleTools::SplineType::monotone);
+    REQUIRE(std::get<1>(line.getY(2.5)) == Approx(6.0));
+
+    std::vector<double> out(2);
+    REQUIRE(line.getY(std::vector<double>(3), out) == simpleTools::InterpolationResultType::dataIncomplete);
+    std::vector<double> repeatedX = {0.0, 1.0, 1.0};
+    simpleTools::splineInterpolation<double, double> repeated(repeatedX, lineY, 1e-9, simpleTools::SplineType::monotone);
+    std::vector<simpleTools::InterpolationResultType> verdicts(2);
+    REQUIRE(repeated.getY(std::vector<double>(2), out, verdicts) == simpleTools::InterpolationResultType::divideByZero);
+    REQUIRE(verdicts[1] == simpleTools::InterpolationResultType::divideByZero);
+}
+
+TEST_CASE("Binary search unsorted data test") {
+    std::shared_ptr<std::vector<std::pair<double, double> > > badData
+    (
+    new std::vector<std::pair<double, double> > (
+    {
+            {1.0,  1.0},
+            {2.5,  1.3},
+            {5.0,  2.0}, /* This is a bad row */
+            {3.75, 0.5},
+            {4.1,  2.25},
+            {5.3,  1.9}
+        } )
+    );
+    simpleTools::interpolation<double, double> badDataIntrp(badData, 0.1, simpleTools::SearchMethod::binarySearch);
+    REQUIRE(std::get<0>(badDataIntrp.getY(4)) == simpleTools::InterpolationResultType::dataUnsorted);
+    REQUIRE(std::get<0>(badDataIntrp.nearestY(4)) == simpleTools::InterpolationResultType::dataUnsorted);
+    REQUIRE(std::get<0>(badDataIntrp.getY(5.2)) == simpleTools::InterpolationResultType::dataUnsorted);
+}
+
+TEST_CASE("Sealed table test") {
+    std::shared_ptr<std::vector<std::pair<double, double> > > data(new std::vector<std::pair<double, double> >(
+            {{1.0, 1.0}}));
+    simpleTools::interpolation<double, double> intrp(data, 0.01);
+    REQUIRE(std::get<0>(intrp.getY(1.5)) == simpleTools::InterpolationResultType::dataIncomplete);
+
+    data->push_back({2.0, 3.0});    //queries trust the last verdict until the table is re-validated
+    REQUIRE(std::get<0>(intrp.getY(1.5)) == simpleTools::InterpolationResultType::dataIncomplete);
+    REQUIRE(intrp.validate() == simpleTools::InterpolationResultType::OK);
+    REQUIRE(std::get<1>(intrp.getY(1.5)) == Approx(2.0));
+    REQUIRE_FALSE(intrp.hasDuplicates());
+
+    data->push_back({2.0, 5.0});
+    REQUIRE(intrp.validate() == simpleTools::InterpolationResultType::OK);
+    REQUIRE(intrp.hasDuplicates());
+    REQUIRE(std::get<1>(intrp.getY(2.0)) == Approx(3.0));   //first of the equal Xs
+
+    data->push_back({1.5, 5.0});
+    REQUIRE(intrp.validate() == simpleTools::InterpolationResultType::dataUnsorted);
+    REQUIRE(std::get<0>(intrp.getY(0.5)) == simpleTools::InterpolationResultType::dataUnsorted);
+    REQUIRE(std::get<0>(intrp.nearestY(0.5)) == simpleTools::InterpolationResultType::dataUnsorted);
+}
+
+TEST_CASE("Compiled table test") {
+    std::mt19937 gen(2003);
+    std::uniform_real_distribution<double> step(0.01, 2.0);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    std::shared_ptr<std::vector<std::pair<double, double> > > data(new std::vector<std::pair<double, double> >);
+    double x = 0.0;
+    for (int i = 0; i < 200; ++i) {
+        x += step(gen);
+        data->push_back({x, value(gen)});
+    }
+    simpleTools::interpolation<double, double> plain(data, 0.01);
+    simpleTools::interpolation<double, double> compiled(data, 0.01);
+    REQUIRE(compiled.compile() == simpleTools::InterpolationResultType::OK);
+
+    for (auto const &item : *data) {
+        auto expected = plain.getY(item.first);
+        auto result = compiled.getY(item.first);
+        REQUIRE(std::get<0>(result) == std::get<0>(expected));
+        REQUIRE(std::get<1>(result) == Approx(std::get<1>(expected)).margin(1e-9));   //the last pair isn't a hit
+    }
+    std::uniform_real_distribution<double> anywhere(-20.0, x + 20.0);
+    for (int i = 0; i < 1000; ++i) {
+        double q = anywhere(gen);
+        auto expected = plain.getY(q);
+        auto result = compiled.getY(q);
+        REQUIRE(std::get<0>(result) == std::get<0>(expected));
+        REQUIRE(std::get<1>(result) == Approx(std::get<1>(expected)).margin(1e-9));
+    }
+
+    std::shared_ptr<std::vector<std::pair<double, double> > > flatEnd(new std::vector<std::pair<double, double> >(
+            {{1.0, 1.0},
+             {2.0, 2.0},
+             {2.0, 3.0}}));     //no slope off the right hand end
+    simpleTools::interpolation<double, double> flatEndIntrp(flatEnd, 0.01);
+    flatEndIntrp.compile();
+    REQUIRE(std::get<0>(flatEndIntrp.getY(5.0)) == simpleTools::InterpolationResultType::divideByZero);
+    REQUIRE(std::get<0>(flatEndIntrp.getY(0.0)) == simpleTools::InterpolationResultType::OK);
+    REQUIRE(std::get<1>(flatEndIntrp.getY(0.0)) == Approx(0.0));
+    REQUIRE(std::get<1>(flatEndIntrp.getY(2.0)) == Approx(2.0));
+
+    flatEnd->push_back({3.0, 4.0});     //recompiled by validate()
+    REQUIRE(flatEndIntrp.validate() == simpleTools::InterpolationResultType::OK);
+    REQUIRE(std::get<1>(flatEndIntrp.getY(4.0)) == Approx(5.0));
+}
+
+TEST_CASE("Shared table stress test") {
+    std::mt19937 gen(1999);
+    std::uniform_real_distribution<double> step(0.01, 1.0);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    std::shared_ptr<std::vector<std::pair<double, double> > > data(new std::vector<std::pair<double, double> >);
+    double x = 0.0;
+    for (int i = 0; i < 5000; ++i) {
+        x += step(gen);
+        data->push_back({x, value(gen)});
+    }
+    simpleTools::interpolation<double, double> const shared(data, 0.01);
+
+    std::uniform_real_distribution<double> anywhere(-10.0, x + 10.0);
+    std::vector<double> queries(20000);
+    for (double &q : queries) q = anywhere(gen);
+    std::vector<std::tuple<simpleTools::InterpolationResultType, double> > expectedY, expectedNearest;
+    for (double q : queries) {
+        expectedY.push_back(shared.getY(q));
+        expectedNearest.push_back(shared.nearestY(q));
+    }
+
+    unsigned threadCount = std::max(4u, std::thread::hardware_concurrency());
+    std::atomic<std::size_t> mismatches(0);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int pass = 0; pass < 20; ++pass) {
+                for (std::size_t i = t; i < queries.size(); i += 7) {   //threads overlap on the same queries
+                    if (shared.getY(queries[i]) != expectedY[i]) ++mismatches;
+                    if (shared.nearestY(queries[i]) != expectedNearest[i]) ++mismatches;
+                }
+            }
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Batch query test") {
+    std::shared_ptr<std::vector<std::pair<double, double> > > graphData(new std::vector<std::pair<double, double> >(
+            {{1.0,  1.0},
+             {2.5,  1.3},
+             {3.0,  2.0},
+             {3.75, 0.5},
+             {4.1,  2.25},
+             {5.0,  1.75},
+             {5.3,  1.9}}));
+    simpleTools::interpolation<double, double> graphDataIntrp(graphData, 0.001);
+
+    std::vector<double> xs({0.0, 0.75, 1.75, 2.75, 3.0, 3.925, 5.15, 5.3, 6.0});
+    std::vector<double> ys(xs.size());
+    std::vector<simpleTools::InterpolationResultType> results(xs.size());
+
+    std::size_t before = allocationCount;
+    {
+        simpleTools::cacheLineVector<double> aligned(16);   //the counter sees the library's aligned allocations
+    }
+    REQUIRE(allocationCount == before + 1);
+
+    before = allocationCount;
+    REQUIRE(graphDataIntrp.getY(xs, ys, results) == simpleTools::InterpolationResultType::OK);
+    REQUIRE(allocationCount == before);
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        REQUIRE(std::make_tuple(results[i], ys[i]) == graphDataIntrp.getY(xs[i]));
+    }
+
+    before = allocationCount;
+    REQUIRE(graphDataIntrp.nearestY(xs, ys, results) == simpleTools::InterpolationResultType::OK);
+    REQUIRE(allocationCount == before);
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        REQUIRE(std::make_tuple(results[i], ys[i]) == graphDataIntrp.nearestY(xs[i]));
+    }
+
+    REQUIRE(graphDataIntrp.getY(xs, ys) == simpleTools::InterpolationResultType::OK);     //results are optional
+    REQUIRE(ys[2] == Approx(1.15).epsilon(0.01));
+
+    std::vector<double> shortYs(3);
+    REQUIRE(graphDataIntrp.getY(xs, shortYs) == simpleTools::InterpolationResultType::dataIncomplete);
+
+    std::shared_ptr<std::vector<std::pair<double, double> > > emptyData(new std::vector<std::pair<double, double> >);
+    simpleTools::interpolation<double, double> emptyIntrp(emptyData, 0.1);
+    REQUIRE(emptyIntrp.getY(xs, ys, results) == simpleTools::InterpolationResultType::dataIncomplete);
+    REQUIRE(results[0] == simpleTools::InterpolationResultType::dataIncomplete);
+    REQUIRE(ys[0] == Approx(0.0));
+}
+
+TEST_CASE("Sorted batch test") {
+    std::mt19937 gen(2011);
+    std::uniform_real_distribution<double> step(0.0, 1.0);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    std::shared_ptr<std::vector<std::pair<double, double> > > data(new std::vector<std::pair<double, double> >);
+    double x = 0.0;
+    for (int i = 0; i < 300; ++i) {
+        if (i % 17 != 5) x += step(gen);    //some repeated Xs
+        data->push_back({x, value(gen)});
+    }
+    simpleTools::interpolation<double, double> intrp(data, 0.01);
+
+    std::uniform_real_distribution<double> anywhere(-5.0, x + 5.0);
+    std::vector<double> xs(2000);
+    for (double &q : xs) q = anywhere(gen);
+    for (auto const &item : *data) xs.push_back(item.first);
+    std::sort(xs.begin(), xs.end());
+
+    std::vector<double> ys(xs.size());
+    std::vector<simpleTools::InterpolationResultType> results(xs.size());
+    for (simpleTools::QueryOrder order : {simpleTools::QueryOrder::detect, simpleTools::QueryOrder::ascending}) {
+        REQUIRE(intrp.getY(xs, ys, results, order) == simpleTools::InterpolationResultType::OK);
+        for (std::size_t i = 0; i < xs.size(); ++i) REQUIRE(std::make_tuple(results[i], ys[i]) == intrp.getY(xs[i]));
+
+        REQUIRE(intrp.nearestY(xs, ys, results, order) == simpleTools::InterpolationResultType::OK);
+        for (std::size_t i = 0; i < xs.size(); ++i) REQUIRE(std::make_tuple(results[i], ys[i]) == intrp.nearestY(xs[i]));
+    }
+
+    std::swap(xs.front(), xs.back());   //detect falls back to searching for each point
+    REQUIRE(intrp.getY(xs, ys, results) == simpleTools::InterpolationResultType::OK);
+    for (std::size_t i = 0; i < xs.size(); ++i) REQUIRE(std::make_tuple(results[i], ys[i]) == intrp.getY(xs[i]));
+}
+
+TEST_CASE("Cursor test") {
+    std::mt19937 gen(2005);
+    std::uniform_real_distribution<double> step(0.0, 1.0);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    std::shared_ptr<std::vector<std::pair<double, double> > > data(new std::vector<std::pair<double, double> >);
+    double x = 0.0;
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 13 != 4) x += step(gen);    //some repeated Xs
+        data->push_back({x, value(gen)});
+    }
+    simpleTools::interpolation<double, double> intrp(data, 0.01);
+    simpleTools::interpolation<double, double>::cursor drifting(intrp);
+    simpleTools::interpolation<double, double>::cursor jumping(intrp);
+
+    std::normal_distribution<double> drift(0.0, 0.3);
+    std::uniform_real_distribution<double> anywhere(-20.0, x + 20.0);
+    double q = x / 2;
+    for (int i = 0; i < 5000; ++i) {
+        q += drift(gen);
+        REQUIRE(drifting.getY(q) == intrp.getY(q));
+        REQUIRE(drifting.nearestY(q) == intrp.nearestY(q));
+
+        double jump = (i % 50 == 0) ? (*data)[static_cast<std::size_t>(i) % data->size()].first : anywhere(gen);
+        REQUIRE(jumping.getY(jump) == intrp.getY(jump));
+        REQUIRE(jumping.nearestY(jump) == intrp.nearestY(jump));
+    }
+
+    std::shared_ptr<std::vector<std::pair<double, double> > > emptyData(new std::vector<std::pair<double, double> >);
+    simpleTools::interpolation<double, double> emptyIntrp(emptyData, 0.1);
+    simpleTools::interpolation<double, double>::cursor emptyCursor(emptyIntrp);
+    REQUIRE(std::get<0>(emptyCursor.getY(1.0)) == simpleTools::InterpolationResultType::dataIncomplete);
+}
+
+TEST_CASE("Uniform grid test") {
+    std::mt19937 gen(2013);
+    std::uniform_real_distribution<double> jitter(-0.0005, 0.0005);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    std::shared_ptr<std::vector<std::pair<double, double> > > sweep(new std::vector<std::pair<double, double> >);
+    for (int i = 0; i < 500; ++i) sweep->push_back({-3.0 + 0.25 * i + jitter(gen), value(gen)});
+    simpleTools::interpolation<double, double> grid(sweep, 0.001);
+    simpleTools::interpolation<double, double> scan(sweep, 0.001, simpleTools::SearchMethod::linearScan);
+    REQUIRE(grid.isUniform());
+
+    std::vector<double> queries;
+    for (auto const &item : *sweep) queries.push_back(item.first);
+    std::uniform_real_distribution<double> anywhere(-10.0, 140.0);
+    for (int i = 0; i < 2000; ++i) queries.push_back(anywhere(gen));
+    for (double q : queries) {
+        REQUIRE(grid.getY(q) == scan.getY(q));
+        REQUIRE(grid.nearestY(q) == scan.nearestY(q));
+    }
+
+    std::shared_ptr<std::vector<std::pair<int, double> > > steps(new std::vector<std::pair<int, double> >(
+            {{10, 1.0},
+             {20, 2.0},
+             {30, 4.0},
+             {40, 8.0}}));
+    simpleTools::interpolation<int, double> intGrid(steps, 0);
+    REQUIRE(intGrid.isUniform());
+    REQUIRE(std::get<1>(intGrid.getY(25)) == Approx(3.0));
+    REQUIRE(std::get<1>(intGrid.getY(30)) == Approx(4.0));
+    REQUIRE(std::get<1>(intGrid.getY(50)) == Approx(12.0));
+    REQUIRE(std::get<1>(intGrid.getY(0)) == Approx(0.0).margin(1e-12));
+
+    steps->push_back({45, 9.0});
+    intGrid.validate();
+    REQUIRE_FALSE(intGrid.isUniform());
+    REQUIRE(std::get<1>(intGrid.getY(25)) == Approx(3.0));
+
+    sweep->push_back(sweep->back());    //a repeated X is never a grid
+    REQUIRE(grid.validate() == simpleTools::InterpolationResultType::OK);
+    REQUIRE_FALSE(grid.isUniform());
+}
+
+template<class T>
+static bool sameBits(T a, T b) {
+    using bits = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+    return std::bit_cast<bits>(a) == std::bit_cast<bits>(b);
+}
+
+TEMPLATE_TEST_CASE("SIMD batch matches scalar getY and nearestY", "", float, double) {
+    std::mt19937 gen(2019);
+    std::uniform_real_distribution<TestType> step(0, 2);
+    std::uniform_real_distribution<TestType> value(-10, 10);
+
+    std::shared_ptr<std::vector<std::pair<TestType, TestType> > > data(new std::vector<std::pair<TestType, TestType> >);
+    TestType x = -50;
+    for (int i = 0; i < 400; ++i) {
+        x += (i % 29 == 7) ? static_cast<TestType>(0.00001) : step(gen);     //a few segments too narrow to divide by
+        data->push_back({x, value(gen)});
+    }
+    data->push_back({x, value(gen)});    //no slope off the right hand end
+    simpleTools::interpolation<TestType, TestType> intrp(data, static_cast<TestType>(0.001));
+
+    std::vector<TestType> xs;
+    for (auto const &item : *data) xs.push_back(item.first);
+    std::uniform_real_distribution<TestType> anywhere(-100, x + 100);
+    for (int i = 0; i < 3000; ++i) xs.push_back(anywhere(gen));
+    std::vector<TestType> ys(xs.size());
+    std::vector<simpleTools::InterpolationResultType> results(xs.size());
+
+    for (simpleTools::QueryOrder order : {simpleTools::QueryOrder::unordered, simpleTools::QueryOrder::detect}) {
+        if (order == simpleTools::QueryOrder::detect) std::sort(xs.begin(), xs.end());
+        REQUIRE(intrp.getY(xs, ys, results, order) == simpleTools::InterpolationResultType::OK);
+        for (std::size_t i = 0; i < xs.size(); ++i) {
+            auto expected = intrp.getY(xs[i]);
+            REQUIRE(results[i] == std::get<0>(expected));
+            REQUIRE(sameBits(ys[i], std::get<1>(expected)));
+        }
+
+        REQUIRE(intrp.nearestY(xs, ys, results, order) == simpleTools::InterpolationResultType::OK);
+        for (std::size_t i = 0; i < xs.size(); ++i) {
+            auto expected = intrp.nearestY(xs[i]);
+            REQUIRE(results[i] == std::get<0>(expected));
+            REQUIRE(sameBits(ys[i], std::get<1>(expected)));
+        }
+    }
+
+    //every kernel this CPU runs, one lane per two-pair table
+    for (simpleTools::simd::instructionSet isa : {simpleTools::simd::instructionSet::baseline,
+                                                  simpleTools::simd::instructionSet::avx2,
+                                                  simpleTools::simd::instructionSet::avx512,
+                                                  simpleTools::simd::instructionSet::portable}) {
+        if (!simpleTools::simd::supported(isa)) continue;
+        std::vector<std::tuple<simpleTools::InterpolationResultType, TestType> > expected;
+        simpleTools::simd::block<TestType> lanes{};
+        std::size_t count = lanes.size - 3;
+        for (std::size_t j = 0; j < count; ++j) {
+            TestType leftX = value(gen);
+            TestType rightX = (j % 9 == 0) ? leftX : leftX + step(gen);
+            lanes.x[j] = (j % 3 == 0) ? leftX + 3 * (rightX - leftX) + 1 : anywhere(gen);
+            lanes.leftX[j] = leftX;
+            lanes.leftY[j] = value(gen);
+            lanes.rightX[j] = rightX;
+            lanes.rightY[j] = value(gen);
+            lanes.extrapolate[j] = (lanes.x[j] < leftX || lanes.x[j] > rightX) ? -1 : 0;
+            lanes.exact[j] = (lanes.x[j] == leftX) ? -1 : 0;
+
+            std::shared_ptr<std::vector<std::pair<TestType, TestType> > > pair(new std::vector<std::pair<TestType, TestType> >(
+                    {{leftX,  lanes.leftY[j]},
+                     {rightX, lanes.rightY[j]}}));
+            expected.push_back(simpleTools::interpolation<TestType, TestType>(pair, 0).getY(lanes.x[j]));
+        }
+        simpleTools::simd::evaluate(isa, count, lanes);
+        for (std::size_t j = 0; j < count; ++j) {
+            bool divideByZero = std::get<0>(expected[j]) == simpleTools::InterpolationResultType::divideByZero;
+            REQUIRE((lanes.divideByZero[j] != 0) == divideByZero);
+            REQUIRE(sameBits(lanes.y[j], std::get<1>(expected[j])));
+        }
+
+        //nearest: x between the pairs, which are at least two precisions apart, exactly on the left one,
+        //or halfway, where both are the same number of precisions away
+        std::uniform_real_distribution<TestType> along(0, 1);
+        expected.clear();
+        lanes.precision = static_cast<TestType>(0.001);
+        for (std::size_t j = 0; j < count; ++j) {
+            TestType leftX = value(gen);
+            TestType rightX = leftX + static_cast<TestType>(0.002) + step(gen);
+            lanes.x[j] = (j % 5 == 0) ? leftX : leftX + (j % 5 == 1 ? static_cast<TestType>(0.5) : along(gen)) * (rightX - leftX);
+            lanes.leftX[j] = leftX;
+            lanes.leftY[j] = value(gen);
+            lanes.rightX[j] = rightX;
+            lanes.rightY[j] = value(gen);
+            lanes.exact[j] = (j % 5 == 0) ? -1 : 0;
+
+            std::shared_ptr<std::vector<std::pair<TestType, TestType> > > pair(new std::vector<std::pair<TestType, TestType> >(
+                    {{leftX,  lanes.leftY[j]},
+                     {rightX, lanes.rightY[j]}}));
+            expected.push_back(simpleTools::interpolation<TestType, TestType>(pair, static_cast<TestType>(0.001)).nearestY(lanes.x[j]));
+        }
+        simpleTools::simd::evaluate(isa, count, lanes, simpleTools::simd::answer::nearest);
+        for (std::size_t j = 0; j < count; ++j) REQUIRE(sameBits(lanes.y[j], std::get<1>(expected[j])));
+    }
+}
+
+/* Not run by default; use: simpleTest "[benchmark]" */
+TEST_CASE("Search crossover benchmark", "[.][benchmark]") {
+    std::mt19937 gen(2021);
+    std::uniform_real_distribution<double> gap(0.5, 1.5);   //uneven, or both would take the grid path
+    for (std::size_t size : {4, 8, 16, 32, 64, 128, 256, 1024, 16384}) {
+        std::shared_ptr<std::vector<std::pair<double, double> > > data(new std::vector<std::pair<double, double> >);
+        double x = 0.0;
+        for (std::size_t i = 0; i < size; ++i) {
+            data->push_back({x, static_cast<double>(i % 7)});
+            x += gap(gen);
+        }
+
+        std::uniform_real_distribution<double> anywhere(0.0, data->back().first);
+        std::vector<double> queries(1024);
+        for (double &q : queries) q = anywhere(gen);
+
+        simpleTools::interpolation<double, double> scan(data, 0.01, simpleTools::SearchMethod::linearScan);
+        simpleTools::interpolation<double, double> bisect(data, 0.01, simpleTools::SearchMethod::binarySearch);
+        REQUIRE(!bisect.isUniform());
+
+        BENCHMARK("linearScan n=" + std::to_string(size)) {
+            double sum = 0;
+            for (double q : queries) sum += std::get<1>(scan.getY(q));
+            return sum;
+        };
+        BENCHMARK("binarySearch n=" + std::to_string(size)) {
+            double sum = 0;
+            for (double q : queries) sum += std::get<1>(bisect.getY(q));
+            return sum;
+        };
+    }
+}
+
+/* Not run by default; use: simpleTest "[benchmark]" */
+TEST_CASE("Uniform grid benchmark", "[.][benchmark]") {
+    std::mt19937 gen(2022);
+    std::uniform_real_distribution<double> jitter(0.1, 0.9);
+    for (std::size_t size : {16, 1024, 65536, 4194304}) {
+        std::shared_ptr<std::vector<std::pair<double, double> > > even(new std::vector<std::pair<double, double> >);
+        std::shared_ptr<std::vector<std::pair<double, double> > > uneven(new std::vector<std::pair<double, double> >);
+        for (std::size_t i = 0; i < size; ++i) {
+            even->push_back({static_cast<double>(i), static_cast<double>(i % 7)});
+            uneven->push_back({static_cast<double>(i) + jitter(gen), static_cast<double>(i % 7)});
+        }
+
+        std::uniform_real_distribution<double> anywhere(0.0, static_cast<double>(size - 1));
+        std::vector<double> queries(1024);
+        for (double &q : queries) q = anywhere(gen);
+
+        simpleTools::interpolation<double, double> grid(even, 0.0001);
+        simpleTools::interpolation<double, double> bisect(uneven, 0.0001);
+
+        BENCHMARK("uniformGrid n=" + std::to_string(size)) {
+            double sum = 0;
+            for (double q : queries) sum += std::get<1>(grid.getY(q));
+            return sum;
+        };
+        BENCHMARK("binarySearch n=" + std::to_string(size)) {
+            double sum = 0;
+            for (double q : queries) sum += std::get<1>(bisect.getY(q));
+            return sum;
+        };
+    }
+}